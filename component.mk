@@ -3,3 +3,18 @@ COMPONENT_SRCDIRS := src $(call ListAllSubDirsSingle,$(COMPONENT_PATH)/src)
 COMPONENT_DOXYGEN_INPUT := include
 COMPONENT_DOCFILES := $(call ListAllFiles,$(COMPONENT_PATH)/docs,*.rst *.png *.jpg)
 COMPONENT_DOCFILES := $(patsubst $(COMPONENT_PATH)/%,%,$(COMPONENT_DOCFILES))
+
+# Modbus RTU CRC16 implementation: bitwise, table, slice4 or slice8 (Host only)
+COMPONENT_VARS += IOCONTROL_CRC16
+IOCONTROL_CRC16 ?= table
+COMPONENT_CXXFLAGS += -DIOCONTROL_CRC16_$(IOCONTROL_CRC16)=1
+
+# Drive all library timing from a simulated clock (Host only)
+COMPONENT_VARS += IOCONTROL_VIRTUAL_CLOCK
+IOCONTROL_VIRTUAL_CLOCK ?= 0
+ifeq ($(IOCONTROL_VIRTUAL_CLOCK),1)
+ifneq ($(SMING_ARCH),Host)
+$(error IOCONTROL_VIRTUAL_CLOCK is only supported for Host builds)
+endif
+endif
+GLOBAL_CFLAGS += -DIOCONTROL_VIRTUAL_CLOCK=$(IOCONTROL_VIRTUAL_CLOCK)
@@ -0,0 +1,125 @@
+/**
+ * CircuitBreaker.h
+ *
+ * Copyright 2022 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the IOControl Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#pragma once
+
+#include "Error.h"
+
+namespace IO
+{
+/**
+ * @brief Default number of consecutive communication failures before a device is taken offline
+ */
+constexpr uint8_t CIRCUIT_BREAKER_THRESHOLD{3};
+
+/**
+ * @brief Initial time (ms) an offline device is left alone before a request is allowed through as a probe
+ */
+constexpr uint32_t CIRCUIT_BREAKER_BACKOFF_MIN{1000};
+
+/**
+ * @brief Upper limit (ms) for probe interval, which doubles each time a probe fails
+ */
+constexpr uint32_t CIRCUIT_BREAKER_BACKOFF_MAX{60000};
+
+/**
+ * @brief Stops requests for an unresponsive device from occupying the bus
+ *
+ *   closed -> open         Threshold reached for consecutive communication failures
+ *   open -> half-open      Backoff interval elapsed, next request is executed as a probe
+ *   half-open -> closed    Probe succeeded
+ *   half-open -> open      Probe failed, backoff interval doubled
+ *
+ * Whilst open, requests are failed immediately with `Error::offline`.
+ */
+class CircuitBreaker
+{
+public:
+	enum class State {
+		closed,   ///< Normal operation
+		open,	 ///< Device offline, requests fail fast
+		halfOpen, ///< Probing device
+	};
+
+	/**
+	 * @brief Set number of consecutive failures before breaker opens
+	 * @param threshold 0 disables the breaker
+	 */
+	void setThreshold(uint8_t threshold)
+	{
+		this->threshold = threshold;
+		reset();
+	}
+
+	State getState() const
+	{
+		return state;
+	}
+
+	/**
+	 * @brief Check whether a request may be queued
+	 * @param now Current system time in milliseconds
+	 *
+	 * Requests are refused whilst open and the backoff interval has not elapsed.
+	 */
+	bool canSubmit(uint32_t now) const
+	{
+		return state != State::open || (now - openTime) >= backoff;
+	}
+
+	/**
+	 * @brief Check whether a request may be executed
+	 * @param now Current system time in milliseconds
+	 *
+	 * If open and the backoff interval has elapsed the breaker moves to half-open
+	 * and the request becomes the probe.
+	 */
+	bool canExecute(uint32_t now);
+
+	/**
+	 * @brief Record the result of an executed request
+	 * @param err Only communication failures (timeout, bad checksum or size) count against the device
+	 * @param now Current system time in milliseconds
+	 */
+	void recordResult(ErrorCode err, uint32_t now);
+
+	/**
+	 * @brief Determine whether an error indicates a failure to communicate with the device
+	 */
+	static bool isFault(ErrorCode err)
+	{
+		return err == Error::timeout || err == Error::bad_checksum || err == Error::bad_size;
+	}
+
+	void reset()
+	{
+		state = State::closed;
+		failCount = 0;
+		backoff = CIRCUIT_BREAKER_BACKOFF_MIN;
+	}
+
+private:
+	uint32_t openTime{0};
+	uint32_t backoff{CIRCUIT_BREAKER_BACKOFF_MIN};
+	State state{State::closed};
+	uint8_t threshold{0};
+	uint8_t failCount{0};
+};
+
+} // namespace IO
@@ -0,0 +1,203 @@
+/**
+ * Clock.h
+ *
+ * Copyright 2022 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the IOControl Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#pragma once
+
+#include <Clock.h>
+#include <SimpleTimer.h>
+
+#if IOCONTROL_VIRTUAL_CLOCK
+#include <Data/LinkedObjectList.h>
+#endif
+
+namespace IO
+{
+/**
+ * @brief Time source for all library timing
+ *
+ * Normally these map directly onto the system clock.
+ *
+ * With `IOCONTROL_VIRTUAL_CLOCK=1` (Host builds only) time is simulated instead:
+ * it stands still until the application calls `Clock::advance()`, which jumps to the next timer deadline.
+ * Long-running simulations, such as soak tests over the virtual RS485 bus, then run as fast as the host can
+ * process them and always produce the same results.
+ *
+ * Hardware-timed operations (RFSwitch transmission) continue to run in real time.
+ */
+namespace Clock
+{
+#if IOCONTROL_VIRTUAL_CLOCK
+
+uint32_t micros();
+uint32_t millis();
+
+/**
+ * @brief Busy-waits complete instantly, advancing the clock
+ */
+void delayMicroseconds(uint32_t us);
+
+/**
+ * @brief Advance to the next timer deadline and fire that timer
+ * @param limit Maximum time to advance, in microseconds
+ * @retval bool false if no timers are running, in which case time doesn't change
+ *
+ * Call repeatedly from a task callback so that work queued by each timer is processed before the next one fires:
+ *
+ *     void step()
+ *     {
+ *         if(IO::Clock::advance()) {
+ *             System.queueCallback(step);
+ *         }
+ *     }
+ */
+bool advance(uint32_t limit = UINT32_MAX);
+
+/**
+ * @brief Get the total simulated time, in microseconds
+ */
+uint64_t now();
+
+/**
+ * @brief Get a pseudo-random number for timing jitter
+ *
+ * The sequence depends only on the seed so simulations are repeatable.
+ */
+uint32_t random();
+
+/**
+ * @brief Restart the pseudo-random sequence
+ * @param value Seed, 0 restores the default
+ */
+void seed(uint32_t value);
+
+#else
+
+inline uint32_t micros()
+{
+	return ::micros();
+}
+
+inline uint32_t millis()
+{
+	return ::millis();
+}
+
+inline void delayMicroseconds(uint32_t us)
+{
+	::delayMicroseconds(us);
+}
+
+inline uint32_t random()
+{
+	return os_random();
+}
+
+#endif
+} // namespace Clock
+
+#if IOCONTROL_VIRTUAL_CLOCK
+
+/**
+ * @brief Timer driven by the virtual clock
+ *
+ * Provides the subset of the SimpleTimer interface used by the library.
+ * Callbacks are made from `Clock::advance()`.
+ */
+class ClockTimer : public LinkedObjectTemplate<ClockTimer>
+{
+public:
+	using Callback = void (*)(void* arg);
+
+	~ClockTimer()
+	{
+		stop();
+	}
+
+	ClockTimer& initializeMs(uint32_t ms, Callback callback, void* arg = nullptr)
+	{
+		setCallback(callback, arg);
+		setIntervalMs(ms);
+		return *this;
+	}
+
+	template <uint32_t ms> ClockTimer& initializeMs(Callback callback, void* arg = nullptr)
+	{
+		return initializeMs(ms, callback, arg);
+	}
+
+	ClockTimer& initializeUs(uint32_t us, Callback callback, void* arg = nullptr)
+	{
+		setCallback(callback, arg);
+		setIntervalUs(us);
+		return *this;
+	}
+
+	void setCallback(Callback callback, void* arg = nullptr)
+	{
+		this->callback = callback;
+		param = arg;
+	}
+
+	/**
+	 * @brief Set the timer interval, restarting the timer if it's running
+	 */
+	bool setIntervalUs(uint64_t us);
+
+	bool setIntervalMs(uint32_t ms)
+	{
+		return setIntervalUs(uint64_t(ms) * 1000);
+	}
+
+	template <uint32_t ms> void setIntervalMs()
+	{
+		setIntervalMs(ms);
+	}
+
+	bool start(bool repeating = true);
+
+	bool startOnce()
+	{
+		return start(false);
+	}
+
+	void stop();
+
+	bool isStarted() const
+	{
+		return started;
+	}
+
+private:
+	friend bool Clock::advance(uint32_t limit);
+
+	uint64_t interval{0};
+	uint64_t due{0};
+	Callback callback{nullptr};
+	void* param{nullptr};
+	bool started{false};
+	bool repeating{false};
+};
+
+#else
+
+using ClockTimer = SimpleTimer;
+
+#endif
+
+} // namespace IO
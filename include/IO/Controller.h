@@ -20,10 +20,16 @@
 #pragma once
 
 #include "Device.h"
+#include "Clock.h"
 #include <WVector.h>
 
 namespace IO
 {
+/**
+ * @brief Default time (in milliseconds) a queued request waits before being promoted to the next priority level
+ */
+constexpr uint16_t QUEUE_AGING_INTERVAL{1000};
+
 using DeviceFactoryList = Vector<const Device::Factory*>;
 
 /**
@@ -46,17 +52,30 @@ class Controller : public LinkedObjectTemplate<Controller>
 public:
 	using List = LinkedObjectListTemplate<Controller>;
 
+	/**
+	 * @brief Queue wait statistics for one priority level
+	 */
+	struct QueueStats {
+		uint32_t count;		///< Number of requests dequeued
+		uint32_t totalWait; ///< Total time spent waiting in queue (ms)
+		uint32_t maxWait;   ///< Longest time spent waiting in queue (ms)
+		uint32_t rejected;  ///< Number of requests refused because a queue limit was reached
+
+		uint32_t averageWait() const
+		{
+			return count ? totalWait / count : 0;
+		}
+	};
+
 	/**
 	 * @brief Construct a controller instance
 	 * @param instance Instance number, must be unique for each class of controller
 	 */
-	Controller(uint8_t instance) : instance(instance)
+	Controller(uint8_t instance) : agingInterval(QUEUE_AGING_INTERVAL), instance(instance)
 	{
 	}
 
-	virtual ~Controller()
-	{
-	}
+	virtual ~Controller();
 
 	/**
 	 * @brief Register a device factory
@@ -86,10 +105,15 @@ public:
 		return devices;
 	}
 
+	const Device::OwnedList& getDevices() const
+	{
+		return devices;
+	}
+
 	/**
 	 * @brief Destroy all devices for this controller
 	 */
-	void freeDevices();
+	virtual void freeDevices();
 
 	/**
 	 * @brief Create a new devicce
@@ -116,8 +140,16 @@ public:
 
 	/**
 	 * @brief Locate a device from its identifier
+	 * @param id Identifier, needn't be NUL-terminated
+	 * @param length Number of characters in identifier
+	 * @note Devices are indexed by the device manager, use `DeviceManager::findDevice()` for faster lookup
 	 */
-	Device* findDevice(const String& id);
+	Device* findDevice(const char* id, size_t length);
+
+	Device* findDevice(const String& id)
+	{
+		return findDevice(id.c_str(), id.length());
+	}
 
 	/**
 	 * @brief Get the class name for this Controller
@@ -133,6 +165,7 @@ public:
 	virtual void start()
 	{
 		startDevices();
+		startPolling();
 	}
 
 	/**
@@ -152,7 +185,112 @@ public:
 	 */
 	virtual bool canStop() const
 	{
-		return queue.isEmpty();
+		return isIdle();
+	}
+
+	/**
+	 * @brief Determine if controller has no active, queued or held requests
+	 */
+	bool isIdle() const;
+
+	/**
+	 * @brief Set time a request must wait before being promoted to the next priority level
+	 * @param interval Time in milliseconds
+	 */
+	void setAgingInterval(uint16_t interval)
+	{
+		agingInterval = interval ?: 1;
+	}
+
+	/**
+	 * @brief Allow requests to be reordered to reduce bus reconfiguration
+	 * @param limit Maximum number of times the request at the head of a queue may be passed over, 0 to disable
+	 *
+	 * When the next request would need the bus reconfiguring (see `isSameLink()`) a later request at the
+	 * same priority which doesn't is executed first. Requests for the same device are never reordered.
+	 */
+	void setBatchLimit(uint8_t limit)
+	{
+		batchLimit = limit;
+	}
+
+	/**
+	 * @brief Limit the number of requests which may be queued
+	 * @param maxRequests Requests submitted beyond this limit complete immediately with `Error::queue_full`.
+	 * Use 0 for no limit.
+	 * @param highWater Queue level at which the device manager's queue callback is invoked to signal congestion.
+	 * It is invoked again when the level falls to half this value. Use 0 to disable.
+	 *
+	 * Requests merged with others count towards the limit as they still occupy memory.
+	 * Devices may also set their own limit, see `Device::Config::queueLimit`.
+	 */
+	void setQueueLimits(uint16_t maxRequests, uint16_t highWater)
+	{
+		queueLimit = maxRequests;
+		queueHighWater = highWater;
+	}
+
+	/**
+	 * @brief Cancel all waiting requests with the given ID
+	 * @param requestId
+	 * @retval unsigned Number of requests cancelled
+	 */
+	unsigned cancelRequests(const String& requestId);
+
+	/**
+	 * @brief Get the number of requests waiting to be executed
+	 */
+	uint16_t getQueueCount() const
+	{
+		return queueCount;
+	}
+
+	/**
+	 * @brief Determine if the queue has reached its high-water mark and not yet drained
+	 */
+	bool isCongested() const
+	{
+		return congested;
+	}
+
+	/**
+	 * @brief Get queue wait statistics for a priority level
+	 */
+	const QueueStats& getQueueStats(Priority priority) const
+	{
+		return queueStats[unsigned(priority)];
+	}
+
+	/**
+	 * @brief Write queue wait statistics for all priority levels in JSON format
+	 */
+	void getQueueStats(JsonObject json) const;
+
+	void resetQueueStats()
+	{
+		memset(queueStats, 0, sizeof(queueStats));
+		mergeCount = 0;
+	}
+
+	/**
+	 * @brief Get timing statistics for all requests executed by this controller
+	 */
+	const LatencyStats& getLatencyStats() const
+	{
+		return latencyStats;
+	}
+
+	void resetLatencyStats()
+	{
+		latencyStats.reset();
+	}
+
+	/**
+	 * @brief Get the number of requests merged with others instead of being executed
+	 */
+	uint32_t getMergeCount() const
+	{
+		return mergeCount;
 	}
 
 	/**
@@ -177,31 +315,101 @@ protected:
 	/**
 	 * @brief Queue a request
 	 *
-	 * The request is started immediately if the queue is empty.
+	 * The request is started immediately if the controller is idle.
 	 */
 	void submit(Request* request);
 
+	/**
+	 * @brief Start the active request executing by raising `Event::Execute`
+	 *
+	 * Controllers which need the bus to stay idle for a time between transactions
+	 * override this to defer execution until it has.
+	 */
+	virtual void startExecution(Request& request);
+
+	/**
+	 * @brief Withdraw a waiting request
+	 * @retval bool false if request is executing or not found
+	 */
+	bool cancel(Request* request);
+
+	/**
+	 * @brief Merge a newly submitted request into one its device is holding back
+	 * @param holder Request which will do the work, held by the controller until `release()` is called
+	 * @param request Request taken by `Device::deferRequest()`
+	 *
+	 * Held requests can be found and cancelled just like queued ones.
+	 */
+	void hold(Request& holder, Request& request);
+
+	/**
+	 * @brief Queue a held request
+	 */
+	void release(Request& holder);
+
+	/**
+	 * @brief Determine whether a request can execute without reconfiguring the bus
+	 *
+	 * Controllers whose devices use differing bus settings override this to support batching.
+	 */
+	virtual bool isSameLink(const Request& request) const
+	{
+		return true;
+	}
+
+	/**
+	 * @brief Get the request currently being executed
+	 */
+	Request* getActiveRequest() const
+	{
+		return activeRequest;
+	}
+
 	void startTimer();
 	void stopTimer();
 
 private:
 	ErrorCode constructDevice(const Device::Factory& factory, const char* id, Device*& device);
+	void addDevice(Device* device);
 
 	void executeNext();
+	Request* dequeue();
+	Request* findBatchable(Request::List& queue);
+	bool coalesce(Request* request);
+	void completeMerged(Request& request);
+	bool checkQueueLimit(Request& request);
+	void queueCountChanged(Request& request, int change);
+	Request* findRequest(const String& requestId);
 
 	void deviceError(Device& device);
 
 	void startDevices();
 	void stopDevices();
+	void startPolling();
+	void schedulePoll();
+	void pollDevices();
 
-	const Device::Factory* findDeviceClass(const String& className);
+	static const Device::Factory* findDeviceClass(const String& className);
 
 	Device::OwnedList devices;
-	Request::OwnedList queue;
+	Request::List queues[PRIORITY_COUNT]; ///< One FIFO for each priority level
+	Request::List held;					  ///< Requests held back by their device, see `hold()`
+	Request* activeRequest{nullptr};
+	QueueStats queueStats[PRIORITY_COUNT]{};
+	LatencyStats latencyStats;
+	uint32_t mergeCount{0};
 	static DeviceFactoryList deviceClasses;
-	std::unique_ptr<SimpleTimer> deviceCheckTimer;
+	std::unique_ptr<ClockTimer> deviceCheckTimer;
+	std::unique_ptr<ClockTimer> pollTimer; ///< Fires when next device is due to be polled
 	CString id;
+	uint16_t agingInterval;
+	uint16_t queueCount{0};
+	uint16_t queueLimit{0};
+	uint16_t queueHighWater{0};
 	uint8_t instance;
+	uint8_t batchLimit{0};
+	uint8_t bypassCount{0}; ///< Times the request at the head of the queue has been passed over
+	bool congested{false};
 };
 
 template <class DeviceClass>
@@ -223,7 +431,7 @@ ErrorCode Controller::createDevice(const char* id, const typename DeviceClass::C
 		return err;
 	}
 
-	devices.add(device);
+	addDevice(device);
 	debug_d("Device %s created, class %s", device->caption().c_str(), String(factory.deviceClass()).c_str());
 
 	return err;
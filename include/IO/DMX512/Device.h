@@ -22,6 +22,8 @@
 #pragma once
 
 #include "../RS485/Device.h"
+#include "Universe.h"
+#include <algorithm>
 #include <Data/Range.h>
 
 namespace IO
@@ -47,6 +49,14 @@ struct NodeData {
 		return (state == State::enabling) || (state == State::disabling) || (target != value);
 	}
 
+	/**
+	 * @brief Determine if adjust() has further work to do
+	 */
+	bool isActive() const
+	{
+		return state != State::disabled && changed();
+	}
+
 	void enable()
 	{
 		if(state != State::enabled) {
@@ -120,6 +130,8 @@ public:
 			DEFINE_FSTR_LOCAL(DEVICE_CLASSNAME, "dmx")
 			return DEVICE_CLASSNAME;
 		}
+
+		RequestPool* getRequestPool() const override;
 	};
 
 	static const Factory factory;
@@ -148,6 +160,9 @@ public:
 	ErrorCode init(JsonObjectConst config) override;
 
 	IO::Request* createRequest() override;
+	RequestPool* getRequestPool() const override;
+
+	Serial::Config getSerialConfig() const override;
 
 	DevNode::ID nodeIdMax() const override
 	{
@@ -182,10 +197,29 @@ protected:
 
 	/** @brief controller calls this before performing an update,
 	 *  typically for effects processing.
+	 *  Only nodes which are still changing are visited.
 	 *  Return true if value changed.
 	 */
 	bool update();
 
+	/**
+	 * @brief Include node in range visited by update()
+	 */
+	void setActive(uint8_t nodeId)
+	{
+		activeStart = std::min(activeStart, nodeId);
+		activeEnd = std::max(activeEnd, uint8_t(nodeId + 1));
+	}
+
+	/**
+	 * @brief Write node value into output frame
+	 */
+	void writeSlot(uint8_t nodeId)
+	{
+		// @todo: Device should perform any necessary translation, e.g. led(value)
+		universe->setSlot(address() + nodeId, nodeData[nodeId].value);
+	}
+
 	void updateSlaves();
 
 	ErrorCode execute(Request& request);
@@ -193,7 +227,10 @@ protected:
 private:
 	uint8_t nodeCount{1};				  ///< Number of DMX slots managed by this device
 	std::unique_ptr<NodeData[]> nodeData; ///< Data for each slot, starting at `address`
-	static SimpleTimer timer;			  ///< For slave update cycle timing
+	Universe* universe{nullptr};		  ///< Output frame, owned by controller
+	uint8_t activeStart{0xff};			  ///< First node requiring update, nodeCount if none
+	uint8_t activeEnd{0};				  ///< One past last node requiring update
+	static ClockTimer timer;			  ///< For slave update cycle timing
 	static bool dataChanged;			  ///< Data has changed
 	static bool updating;				  ///< Currently sending update
 };
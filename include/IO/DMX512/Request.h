@@ -35,6 +35,18 @@ public:
 	{
 	}
 
+	static RequestPool pool; ///< Shared by all devices of this class
+
+	static void* operator new(size_t size) noexcept
+	{
+		return pool.allocate(size);
+	}
+
+	static void operator delete(void* ptr)
+	{
+		pool.release(ptr);
+	}
+
 	Device& getDevice()
 	{
 		return static_cast<Device&>(device);
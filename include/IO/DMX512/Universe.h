@@ -0,0 +1,76 @@
+/**
+ * DMX512/Universe.h
+ *
+ * Copyright 2022 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the IOControl Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+namespace IO
+{
+namespace DMX512
+{
+/**
+ * @brief Output frame for one DMX512 universe
+ *
+ * The frame is kept between updates and devices write their slot values into it
+ * as they change, so sending an update requires no per-slot work.
+ */
+class Universe
+{
+public:
+	static constexpr uint16_t MaxSlots{512};
+
+	/**
+	 * @brief Set the value for a slot
+	 * @param address Slot address, 1 - 512
+	 * @param value
+	 */
+	void setSlot(uint16_t address, uint8_t value)
+	{
+		if(address != 0 && address <= MaxSlots) {
+			frame[address] = value;
+		}
+	}
+
+	uint8_t getSlot(uint16_t address) const
+	{
+		return (address == 0 || address > MaxSlots) ? 0 : frame[address];
+	}
+
+	/**
+	 * @brief Get the complete frame, starting with the start code
+	 */
+	const uint8_t* getFrame() const
+	{
+		return frame;
+	}
+
+	static constexpr size_t getFrameSize()
+	{
+		return sizeof(frame);
+	}
+
+private:
+	// Start code (0x00 for lighting), slots, then padding
+	uint8_t frame[1 + MaxSlots + 2]{};
+};
+
+} // namespace DMX512
+} // namespace IO
@@ -21,6 +21,9 @@
 
 #include "Request.h"
 #include "DeviceType.h"
+#include "RequestPool.h"
+#include "CircuitBreaker.h"
+#include "Latency.h"
 #include <ArduinoJson.h>
 #include <Data/LinkedObjectList.h>
 
@@ -66,6 +69,16 @@ public:
 		 */
 		virtual const FlashString& deviceClass() const = 0;
 
+		/**
+		 * @brief Return the pool used to allocate requests for this device class, if any
+		 *
+		 * The Device Manager sizes pools using the `pools` section of the device configuration.
+		 */
+		virtual RequestPool* getRequestPool() const
+		{
+			return nullptr;
+		}
+
 		bool operator==(const String& className) const
 		{
 			return this->deviceClass() == className;
@@ -79,6 +92,24 @@ public:
 	 */
 	struct Config {
 		String name;
+		uint16_t queueLimit;	  ///< Maximum number of queued requests, 0 for no limit
+		uint8_t breakerThreshold; ///< Consecutive failures before device is taken offline, 0 to disable
+		uint32_t pollInterval;	///< Time (ms) between background state queries, 0 to disable
+	};
+
+	/**
+	 * @brief Statistics for periodic state queries
+	 */
+	struct PollStats {
+		uint32_t count;	///< Number of polls completed successfully
+		uint32_t missed;   ///< Polls skipped because the previous one was still waiting, or which failed
+		uint32_t totalLag; ///< Total time (ms) from each poll falling due to its completion
+		uint32_t maxLag;   ///< Longest time (ms) from a poll falling due to its completion
+
+		uint32_t averageLag() const
+		{
+			return count ? totalLag / count : 0;
+		}
 	};
 
 	/*
@@ -121,10 +152,28 @@ public:
 
 	/**
 	 * @brief Create a request object for this device
-	 * @retval Request* Caller must destroy or submit the request
+	 * @retval Request* Caller must destroy or submit the request, nullptr if request pool is exhausted
 	 */
 	virtual Request* createRequest() = 0;
 
+	/**
+	 * @brief Get the pool from which requests for this device are allocated
+	 * @retval RequestPool* nullptr if requests are allocated from the heap
+	 */
+	virtual RequestPool* getRequestPool() const
+	{
+		return nullptr;
+	}
+
+	/**
+	 * @brief Get the appropriate error code for a failed call to createRequest()
+	 */
+	ErrorCode getCreateError() const
+	{
+		auto pool = getRequestPool();
+		return (pool != nullptr && pool->isExhausted()) ? Error::queue_full : Error::no_mem;
+	}
+
 	/**
 	 * @brief The unique device identifier
 	 */
@@ -146,6 +195,68 @@ public:
 		return name ?: id;
 	}
 
+	/**
+	 * @brief Get the maximum number of requests which may be queued for this device
+	 * @retval uint16_t 0 if there is no device-specific limit
+	 */
+	uint16_t getQueueLimit() const
+	{
+		return queueLimit;
+	}
+
+	/**
+	 * @brief Get the number of requests currently queued for this device
+	 */
+	uint16_t getQueueCount() const
+	{
+		return queueCount;
+	}
+
+	/**
+	 * @brief Get the circuit breaker which takes this device offline after repeated failures
+	 */
+	const CircuitBreaker& getBreaker() const
+	{
+		return breaker;
+	}
+
+	/**
+	 * @brief Get time between periodic state queries
+	 * @retval uint32_t Interval in milliseconds, 0 if device isn't polled
+	 */
+	uint32_t getPollInterval() const
+	{
+		return pollInterval;
+	}
+
+	const PollStats& getPollStats() const
+	{
+		return pollStats;
+	}
+
+	/**
+	 * @brief Write poll statistics in JSON format
+	 */
+	void getPollStats(JsonObject json) const;
+
+	void resetPollStats()
+	{
+		pollStats = PollStats{};
+	}
+
+	/**
+	 * @brief Get timing statistics for requests executed by this device
+	 */
+	const LatencyStats& getLatencyStats() const
+	{
+		return latencyStats;
+	}
+
+	void resetLatencyStats()
+	{
+		latencyStats.reset();
+	}
+
 	/**
 	 * @brief Devices with a numeric address should implement this method
 	 */
@@ -224,13 +335,50 @@ protected:
 	virtual ErrorCode stop();
 
 	void submit(Request* request);
+	bool cancel(Request* request);
+
+	/**
+	 * @brief Offer a newly submitted request to the device before it's queued
+	 * @retval bool true if the device has taken the request
+	 *
+	 * Called once the controller has accepted the request, but not when the active request is re-submitted.
+	 * A device which takes a request must pass it to `holdRequest()`.
+	 */
+	virtual bool deferRequest(Request& request)
+	{
+		return false;
+	}
+
+	/**
+	 * @brief Hold back a request taken by `deferRequest()`
+	 * @see `Controller::hold()`
+	 */
+	void holdRequest(Request& holder, Request& request);
+
+	/**
+	 * @brief Queue a held request
+	 */
+	void releaseRequest(Request& holder);
 
 	Controller& controller;
 
 private:
+	void poll(uint32_t due);
+	void pollComplete(const Request& request);
+
 	CString id;
 	CString name;
 	State state{};
+	Request* startRequest{nullptr}; ///< Outstanding start-up query
+	CircuitBreaker breaker;
+	PollStats pollStats{};
+	LatencyStats latencyStats;
+	uint32_t pollInterval{0};
+	uint32_t nextPoll{0}; ///< Time (ms) next poll falls due
+	uint32_t pollDue{0};  ///< Time (ms) outstanding poll fell due
+	uint16_t queueLimit{0};
+	uint16_t queueCount{0};
+	bool pollPending{false};
 };
 
 } // namespace IO
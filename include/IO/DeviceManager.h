@@ -22,7 +22,10 @@
 #include <WString.h>
 #include "Controller.h"
 #include "Request.h"
+#include "HashIndex.h"
+#include "NodeMonitor.h"
 #include <ArduinoJson.h>
+#include <Data/CString.h>
 
 namespace IO
 {
@@ -31,6 +34,36 @@ class Request;
 class DeviceManager
 {
 public:
+	/**
+	 * @brief Callback invoked when a controller queue becomes congested or drains
+	 * @see `Controller::setQueueLimits()`, `Controller::isCongested()`
+	 */
+	using QueueCallback = Delegate<void(Controller& controller)>;
+
+	/**
+	 * @brief Selects the requests a listener is called for
+	 *
+	 * All criteria must match. The default filter matches every request.
+	 */
+	struct RequestFilter {
+		enum class Phase {
+			execute,  ///< Request is about to execute
+			complete, ///< Request has completed
+		};
+		using Phases = BitSet<uint8_t, Phase, 2>;
+		using DeviceTypes = BitSet<uint8_t, DeviceType>;
+
+		CString deviceId;						   ///< Only requests for this device, empty for all
+		DeviceTypes types{DeviceTypes::domain()}; ///< Only requests for these types of device
+		Phases phases{Phases::domain()};		   ///< Only at these points
+
+		bool matches(const Request& request, Phase phase) const
+		{
+			return phases[phase] && types[request.device.type()] &&
+				   (!deviceId || deviceId == request.device.getId().c_str());
+		}
+	};
+
 	/**
 	 * @brief Controllers register themselves so they can be located
 	 * @note we don't own the controller; these are typically static objects
@@ -42,9 +75,21 @@ public:
 	 */
 	void registerDeviceClass(const Device::Factory& devclass);
 
+	/**
+	 * @brief Locate a controller from its identifier
+	 * @param id Identifier, needn't be NUL-terminated
+	 * @param length Number of characters in identifier
+	 */
+	Controller* findController(const char* id, size_t length);
+
+	Controller* findController(const char* id)
+	{
+		return id ? findController(id, strlen(id)) : nullptr;
+	}
+
 	Controller* findController(const String& id)
 	{
-		return std::find(controllers.begin(), controllers.end(), id);
+		return findController(id.c_str(), id.length());
 	}
 
 	/**
@@ -60,9 +105,29 @@ public:
 
 	bool canStop() const;
 
-	Device* findDevice(const String& id);
+	/**
+	 * @brief Locate a device from its identifier
+	 * @param id Identifier, needn't be NUL-terminated
+	 * @param length Number of characters in identifier
+	 */
+	Device* findDevice(const char* id, size_t length);
+
+	Device* findDevice(const char* id)
+	{
+		return id ? findDevice(id, strlen(id)) : nullptr;
+	}
+
+	Device* findDevice(const String& id)
+	{
+		return findDevice(id.c_str(), id.length());
+	}
+
+	ErrorCode createRequest(const char* devid, Request*& request);
 
-	ErrorCode createRequest(const String& devid, Request*& request);
+	ErrorCode createRequest(const String& devid, Request*& request)
+	{
+		return createRequest(devid.c_str(), request);
+	}
 
 	/*
 	 * Generally, requests should fit into the general model so that IO::Request can be used.
@@ -82,9 +147,17 @@ public:
 		return err;
 	}
 
+	/**
+	 * @brief Cancel all waiting requests with the given ID
+	 * @retval unsigned Number of requests cancelled
+	 * @see `Request::cancel()`
+	 */
+	unsigned cancelRequests(const String& requestId);
+
 	/**
 	 * @brief set the callback handler function for all I/O requests
 	 * @note Callback invoked twice; once when executed, then again when completed.
+	 * @see Use `addListener()` where more than one handler is required
 	 */
 	void setCallback(Request::Callback callback)
 	{
@@ -100,13 +173,117 @@ public:
 		if(requestCallback) {
 			requestCallback(request);
 		}
+		if(!listeners.isEmpty()) {
+			invokeListeners(request);
+		}
+		if(!request.isPending()) {
+			nodeMonitor.deviceUpdated(request.device);
+		}
+	}
+
+	/**
+	 * @brief Subscribe to node state changes
+	 * @param device Device to monitor, nullptr for all devices
+	 * @param node Node to monitor, DevNode_ALL for all nodes
+	 * @param callback Invoked at most once per event loop tick with all matching changes
+	 * @retval uint16_t Subscription identifier, 0 on failure
+	 * @see `NodeMonitor`
+	 */
+	uint16_t subscribe(const Device* device, DevNode node, NodeMonitor::Callback callback)
+	{
+		return nodeMonitor.subscribe(device, node, callback);
+	}
+
+	/**
+	 * @brief Cancel a subscription
+	 * @param id Value returned from subscribe()
+	 */
+	bool unsubscribe(uint16_t id)
+	{
+		return nodeMonitor.unsubscribe(id);
+	}
+
+	/**
+	 * @brief Register an additional request callback
+	 * @param callback
+	 * @param filter Determines which requests the callback is invoked for.
+	 * This is checked before the callback, so listeners cost nothing for requests they aren't interested in.
+	 * @retval uint16_t Listener identifier, 0 on failure
+	 */
+	uint16_t addListener(Request::Callback callback, const RequestFilter& filter);
+
+	uint16_t addListener(Request::Callback callback)
+	{
+		return addListener(callback, RequestFilter{});
+	}
+
+	/**
+	 * @brief Remove a listener
+	 * @param id Value returned from addListener()
+	 * @retval bool false if listener not found
+	 */
+	bool removeListener(uint16_t id);
+
+	/**
+	 * @brief Set a callback to allow front-end to throttle requests when a controller is congested
+	 */
+	void onQueueChange(QueueCallback callback)
+	{
+		queueCallback = callback;
+	}
+
+	/**
+	 * @brief Invoke the queue callback, if one is registered
+	 * @note called by Controller
+	 */
+	void invokeQueueCallback(Controller& controller)
+	{
+		if(queueCallback) {
+			queueCallback(controller);
+		}
 	}
 
 	ErrorCode handleMessage(JsonObject json, Request::Callback callback);
 
+	/**
+	 * @brief Get request pool statistics for all registered device classes
+	 * @param json Receives one object per device class, see `RequestPool::getJson()`
+	 */
+	void getPoolStats(JsonObject json) const;
+
+	/**
+	 * @brief Get request timing statistics for all controllers and devices
+	 * @param json Receives `controllers` and `devices` objects keyed by ID, see `LatencyStats::getJson()`
+	 */
+	void getLatencyStats(JsonObject json) const;
+
+	/**
+	 * @brief Called by controllers when devices are created or destroyed
+	 */
+	void devicesChanged()
+	{
+		deviceIndex.clear();
+		nodeMonitor.reset();
+	}
+
 private:
+	class Listener : public ListenerList<Listener>::Item
+	{
+	public:
+		Request::Callback callback;
+		RequestFilter filter;
+	};
+
+	bool buildIndex();
+	void invokeListeners(Request& request);
+
 	Controller::List controllers; ///< We don't own the controllers
+	HashIndex<Controller> controllerIndex;
+	HashIndex<Device> deviceIndex;
 	Request::Callback requestCallback;
+	ListenerList<Listener> listeners;
+	QueueCallback queueCallback;
+	NodeMonitor nodeMonitor;
 };
 
 extern DeviceManager devmgr;
@@ -64,7 +64,8 @@ enum ErrorMax : ErrorCode {
 	XX(no_command, "Command not specified")                                                                            \
 	XX(no_address, "Device address not specified")                                                                     \
 	XX(no_baudrate, "Device baud rate not specified")                                                                  \
-	XX(no_code, "RF code not specified")
+	XX(no_code, "RF code not specified")                                                                               \
+	XX(offline, "Device is offline")
 
 enum Common : ErrorCode {
 	success = 0,
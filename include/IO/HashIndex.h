@@ -0,0 +1,133 @@
+/**
+ * HashIndex.h
+ *
+ * Copyright 2022 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the IOControl Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#pragma once
+
+#include <memory>
+#include <cstring>
+
+namespace IO
+{
+/**
+ * @brief Open-addressed hash table for locating objects by identifier
+ * @tparam ObjectType Must provide `getId()` returning a `CString`
+ *
+ * The index doesn't own the objects. It must be rebuilt if objects are added or removed.
+ * Table size is at least twice the number of objects so probe sequences stay short.
+ */
+template <class ObjectType> class HashIndex
+{
+public:
+	/**
+	 * @brief FNV-1a hash
+	 */
+	static uint32_t hash(const char* key, size_t length)
+	{
+		uint32_t h{2166136261U};
+		while(length--) {
+			h ^= uint8_t(*key++);
+			h *= 16777619U;
+		}
+		return h;
+	}
+
+	/**
+	 * @brief Discard existing content and size table to suit a number of objects
+	 * @param count Number of objects which will be added
+	 * @retval bool false on memory allocation failure
+	 */
+	bool reset(size_t count)
+	{
+		size_t size{8};
+		while(size < count * 2) {
+			size <<= 1;
+		}
+		entries.reset(new Entry[size]{});
+		mask = entries ? size - 1 : 0;
+		return bool(entries);
+	}
+
+	void clear()
+	{
+		entries.reset();
+		mask = 0;
+	}
+
+	bool isValid() const
+	{
+		return bool(entries);
+	}
+
+	/**
+	 * @brief Add an object to the index
+	 * @note Table must have been sized to accommodate it
+	 */
+	void add(ObjectType& object)
+	{
+		auto& id = object.getId();
+		auto h = hash(id.c_str(), id.length());
+		for(auto i = h & mask;; i = (i + 1) & mask) {
+			auto& e = entries[i];
+			if(e.object == nullptr) {
+				e.object = &object;
+				e.hash = h;
+				return;
+			}
+		}
+	}
+
+	/**
+	 * @brief Locate an object
+	 * @param key Identifier, needn't be NUL-terminated
+	 * @param length Number of characters in key
+	 * @retval ObjectType* nullptr if not found
+	 */
+	ObjectType* find(const char* key, size_t length) const
+	{
+		if(!entries) {
+			return nullptr;
+		}
+
+		auto h = hash(key, length);
+		for(auto i = h & mask;; i = (i + 1) & mask) {
+			auto& e = entries[i];
+			if(e.object == nullptr) {
+				return nullptr;
+			}
+			if(e.hash != h) {
+				continue;
+			}
+			auto& id = e.object->getId();
+			if(id.length() == length && memcmp(id.c_str(), key, length) == 0) {
+				return e.object;
+			}
+		}
+	}
+
+private:
+	struct Entry {
+		ObjectType* object;
+		uint32_t hash;
+	};
+
+	std::unique_ptr<Entry[]> entries;
+	size_t mask{0};
+};
+
+} // namespace IO
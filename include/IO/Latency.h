@@ -0,0 +1,119 @@
+/**
+ * Latency.h
+ *
+ * Copyright 2022 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the IOControl Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#pragma once
+
+#include <ArduinoJson.h>
+
+namespace IO
+{
+class Request;
+
+/**
+ * @brief Fixed-size histogram of times on a log2 scale
+ *
+ * Bucket 0 counts values below 128us, each subsequent bucket covers twice the range of the previous one.
+ * The last bucket counts everything from about 2 seconds upwards.
+ */
+class LatencyHistogram
+{
+public:
+	static constexpr unsigned BUCKET_COUNT{16};
+	static constexpr unsigned MIN_SHIFT{7}; ///< Upper bound of first bucket is 2^MIN_SHIFT us
+
+	/**
+	 * @brief Record a time
+	 * @param us Time in microseconds
+	 */
+	void add(uint32_t us);
+
+	uint32_t getCount() const
+	{
+		return count;
+	}
+
+	uint32_t getMax() const
+	{
+		return max;
+	}
+
+	uint32_t getAverage() const
+	{
+		return count ? sum / count : 0;
+	}
+
+	/**
+	 * @brief Estimate a percentile
+	 * @param percent 0 - 100
+	 * @retval uint32_t Upper bound (us) of the bucket containing the percentile
+	 */
+	uint32_t getPercentile(unsigned percent) const;
+
+	/**
+	 * @brief Get upper bound of a bucket
+	 */
+	static constexpr uint32_t bucketLimit(unsigned bucket)
+	{
+		return uint32_t(1) << (MIN_SHIFT + bucket);
+	}
+
+	void getJson(JsonObject json) const;
+
+	void reset()
+	{
+		*this = LatencyHistogram{};
+	}
+
+private:
+	uint64_t sum{0};
+	uint32_t count{0};
+	uint32_t max{0};
+	uint16_t buckets[BUCKET_COUNT]{}; ///< Saturating counts
+};
+
+/**
+ * @brief Request timings broken down by stage
+ *
+ * Only requests which were executed are included.
+ */
+struct LatencyStats {
+	LatencyHistogram wait;	 ///< Submission to execution, i.e. time spent queued
+	LatencyHistogram transmit; ///< Execution to end of transmission
+	LatencyHistogram response; ///< End of transmission to receipt of response
+	LatencyHistogram total;	///< Submission to completion
+
+	/**
+	 * @brief Record timings for a completed request
+	 * @param request
+	 * @param now Completion time in microseconds
+	 */
+	void add(const Request& request, uint32_t now);
+
+	void getJson(JsonObject json) const;
+
+	void reset()
+	{
+		wait.reset();
+		transmit.reset();
+		response.reset();
+		total.reset();
+	}
+};
+
+} // namespace IO
@@ -0,0 +1,144 @@
+/**
+ * ListenerList.h
+ *
+ * Copyright 2022 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the IOControl Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#pragma once
+
+#include <Data/LinkedObjectList.h>
+
+namespace IO
+{
+/**
+ * @brief Owned list of callback registrations, each identified by a non-zero ID
+ *
+ * Registrations may be removed from within a callback. They're marked and purged
+ * once the outermost dispatch has finished so iteration isn't disturbed.
+ *
+ * @tparam Entry Registration class, inherits from `ListenerList<Entry>::Item`
+ */
+template <class Entry> class ListenerList
+{
+public:
+	class Item : public LinkedObjectTemplate<Entry>
+	{
+	public:
+		uint16_t id{0}; ///< 0 if removed during dispatch
+	};
+
+	/**
+	 * @brief Add a registration
+	 * @param entry Allocated by caller, owned by this list
+	 * @retval uint16_t Identifier, 0 if entry is nullptr
+	 */
+	uint16_t add(Entry* entry)
+	{
+		if(entry == nullptr) {
+			return 0;
+		}
+		if(++lastId == 0) {
+			++lastId;
+		}
+		entry->id = lastId;
+		entries.add(entry);
+		return lastId;
+	}
+
+	/**
+	 * @brief Remove a registration
+	 * @param id Value returned from add()
+	 * @retval bool false if not found
+	 */
+	bool remove(uint16_t id)
+	{
+		if(id == 0) {
+			return false;
+		}
+		for(auto& entry : entries) {
+			if(entry.id != id) {
+				continue;
+			}
+			if(depth != 0) {
+				// Removed once callbacks have finished
+				entry.id = 0;
+			} else {
+				entries.remove(&entry);
+			}
+			return true;
+		}
+		return false;
+	}
+
+	bool isEmpty() const
+	{
+		return entries.isEmpty();
+	}
+
+	/**
+	 * @brief Determine whether any registration satisfies a condition
+	 */
+	template <typename Predicate> bool any(Predicate predicate) const
+	{
+		for(auto& entry : entries) {
+			if(entry.id != 0 && predicate(entry)) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/**
+	 * @brief Call a function for each registration
+	 * @note Calls may be nested
+	 */
+	template <typename Function> void dispatch(Function function)
+	{
+		++depth;
+		for(auto& entry : entries) {
+			if(entry.id != 0) {
+				function(entry);
+			}
+		}
+		if(--depth == 0) {
+			purge();
+		}
+	}
+
+private:
+	void purge()
+	{
+		for(;;) {
+			Entry* removed{nullptr};
+			for(auto& entry : entries) {
+				if(entry.id == 0) {
+					removed = &entry;
+					break;
+				}
+			}
+			if(removed == nullptr) {
+				break;
+			}
+			entries.remove(removed);
+		}
+	}
+
+	OwnedLinkedObjectListTemplate<Entry> entries;
+	uint16_t lastId{0};
+	uint8_t depth{0}; ///< Nesting level of dispatch()
+};
+
+} // namespace IO
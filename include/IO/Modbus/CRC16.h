@@ -0,0 +1,76 @@
+/**
+ * CRC16.h
+ *
+ * Copyright 2022 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the IOControl Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+namespace IO
+{
+namespace Modbus
+{
+/**
+ * @brief CRC16 as used for Modbus RTU frames (polynomial 0xA001 reflected, initial value 0xFFFF)
+ *
+ * The implementation used by `update()` is selected at build time using `IOCONTROL_CRC16`.
+ * All variants are available for comparison (see Benchmark sample).
+ */
+namespace CRC16
+{
+constexpr uint16_t INITIAL_VALUE{0xFFFF};
+
+/**
+ * @brief Update CRC with a block of data, using the configured implementation
+ */
+uint16_t update(uint16_t crc, const void* data, size_t count);
+
+/**
+ * @brief Calculate CRC for a block of data
+ */
+inline uint16_t calculate(const void* data, size_t count)
+{
+	return update(INITIAL_VALUE, data, count);
+}
+
+/**
+ * @brief Compute one bit at a time. Smallest code, no tables.
+ */
+uint16_t updateBitwise(uint16_t crc, const void* data, size_t count);
+
+/**
+ * @brief Compute one byte at a time using a 512-byte table (in flash)
+ */
+uint16_t updateTable(uint16_t crc, const void* data, size_t count);
+
+#ifdef ARCH_HOST
+/**
+ * @brief Compute four bytes at a time using a 2K table
+ */
+uint16_t updateSlice4(uint16_t crc, const void* data, size_t count);
+
+/**
+ * @brief Compute eight bytes at a time using a 4K table
+ */
+uint16_t updateSlice8(uint16_t crc, const void* data, size_t count);
+#endif
+
+} // namespace CRC16
+} // namespace Modbus
+} // namespace IO
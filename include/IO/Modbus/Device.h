@@ -21,6 +21,7 @@
 
 #include "../RS485/Device.h"
 #include "ADU.h"
+#include "WriteCache.h"
 
 namespace IO
 {
@@ -28,6 +29,11 @@ namespace Modbus
 {
 class Request;
 
+/**
+ * @brief Time (ms) allowed for slaves to process a broadcast request before the next transaction
+ */
+constexpr unsigned BROADCAST_TURNAROUND_DELAY{100};
+
 /**
  * @brief A virtual device, represents a modbus slave device.
  *
@@ -39,10 +45,32 @@ class Request;
  */
 class Device : public RS485::Device
 {
+	friend Request;
+	friend WriteCache;
+
 public:
+	/**
+	 * @brief Modbus configuration
+	 */
+	struct Config {
+		RS485::Device::Config rs485;
+		/**
+		 * Hold register writes for up to this many milliseconds so they can be combined.
+		 * 0 disables write-behind caching. See `WriteCache`.
+		 */
+		uint16_t writeBehind;
+	};
+
 	using RS485::Device::Device;
 
-	ErrorCode init(const RS485::Device::Config& config);
+	~Device()
+	{
+		// Cached writes are cancelled, so do that whilst this object is intact
+		writeCache.reset();
+	}
+
+	ErrorCode init(const Config& config);
+	ErrorCode init(JsonObjectConst config) override;
 
 	const DeviceType type() const override
 	{
@@ -65,11 +93,28 @@ public:
 
 	void handleEvent(IO::Request* request, Event event) override;
 
+	/**
+	 * @brief Get the write-behind cache
+	 * @retval WriteCache* nullptr if not enabled
+	 */
+	WriteCache* getWriteCache()
+	{
+		return writeCache.get();
+	}
+
+protected:
+	void parseJson(JsonObjectConst json, Config& cfg);
+	bool deferRequest(IO::Request& request) override;
+
 private:
 	ErrorCode execute(Request* request);
 	ErrorCode readResponse(Request* request);
+	ErrorCode completeBroadcast(Request* request);
 
 	Function requestFunction{};
+	uint8_t broadcastData[6]; ///< Request data from which to construct echo response
+	bool turnaround{false};   ///< Broadcast sent, waiting for turnaround delay
+	std::unique_ptr<WriteCache> writeCache;
 };
 
 } // namespace Modbus
@@ -449,6 +449,15 @@ struct PDU {
 	}
 	/** @} */
 
+	/**
+	 * @brief Determine size of the response to this request
+	 * @retval size_t PDU size (function + data), 0 if it can't be determined in advance
+	 * @note Call before byte-swapping the request, i.e. before `ADU::prepareRequest()`.
+	 *
+	 * An exception response is shorter, so the caller must still handle an early end-of-frame.
+	 */
+	size_t getExpectedResponseSize() const;
+
 	/* Structure content */
 
 	uint8_t functionCode;
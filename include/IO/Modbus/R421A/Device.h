@@ -28,6 +28,9 @@
  *
  * The query command returns a range of states, but other commands work with only a single channel.
  * We therefore implement a mechanism to iterate through all requested channels using the same request.
+ * The exception is turning all channels on or off, for which the board has dedicated commands.
+ * These affect every relay on the board, so are only used if all channels (as configured) are requested.
+ * The board doesn't support WriteMultipleRegisters.
  *
  * There is a similar 4-channel board but with no markings and (as yet) no documentation.
  * However all commands appear to work so a designation of R421A04 seems appropriate.
@@ -83,6 +86,8 @@ public:
 			DEFINE_FSTR_LOCAL(DEVICE_CLASSNAME, "r421a")
 			return DEVICE_CLASSNAME;
 		}
+
+		RequestPool* getRequestPool() const override;
 	};
 
 	static const Factory factory;
@@ -95,12 +100,21 @@ public:
 		uint8_t channels;			   ///< Number of channels (typically 4 or 8)
 	};
 
+	/**
+	 * @brief Bus usage for a command
+	 */
+	struct CommandStats {
+		uint32_t count;		   ///< Number of requests executed
+		uint32_t transactions; ///< Number of bus transactions performed by those requests
+	};
+
 	using Modbus::Device::Device;
 
 	ErrorCode init(const Config& config);
 	ErrorCode init(JsonObjectConst config) override;
 
 	IO::Request* createRequest() override;
+	RequestPool* getRequestPool() const override;
 
 	const StateMask& getStates() const
 	{
@@ -131,6 +145,21 @@ public:
 
 	void handleEvent(IO::Request* request, Event event) override;
 
+	const CommandStats& getCommandStats(Command command) const
+	{
+		return commandStats[unsigned(command)];
+	}
+
+	/**
+	 * @brief Write statistics for commands which have been used in JSON format
+	 */
+	void getCommandStats(JsonObject json) const;
+
+	void resetCommandStats()
+	{
+		memset(commandStats, 0, sizeof(commandStats));
+	}
+
 protected:
 	void parseJson(JsonObjectConst json, Config& cfg);
 
@@ -139,6 +168,7 @@ private:
 	StateMask states{};
 	// Depends on device variant (e.g. 8, 4)
 	uint8_t channelCount{0};
+	CommandStats commandStats[COMMAND_COUNT]{};
 };
 
 } // namespace R421A
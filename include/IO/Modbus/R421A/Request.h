@@ -37,6 +37,18 @@ public:
 	{
 	}
 
+	static RequestPool pool; ///< Shared by all devices of this class
+
+	static void* operator new(size_t size) noexcept
+	{
+		return pool.allocate(size);
+	}
+
+	static void operator delete(void* ptr)
+	{
+		pool.release(ptr);
+	}
+
 	ErrorCode parseJson(JsonObjectConst json) override;
 
 	void getJson(JsonObject json) const override;
@@ -91,10 +103,24 @@ public:
 		return response;
 	}
 
+	/**
+	 * @brief Get the number of bus transactions this request has performed
+	 */
+	uint8_t getTransactionCount() const
+	{
+		return transactionCount;
+	}
+
+	Merge checkMerge(const IO::Request& other) const override;
+	void copyResult(const IO::Request& other) override;
+
 	Function fillRequestData(PDU::Data& data) override;
 	ErrorCode callback(PDU& pdu) override;
 
 private:
+	Function fillChannelData(PDU::Data& data);
+	bool isAllChannels() const;
+
 	// Associated command data
 	struct CommandData {
 		BitSet32 channelMask;
@@ -103,6 +129,7 @@ private:
 
 	CommandData commandData{};
 	StateMask response{};
+	uint8_t transactionCount{0};
 };
 
 } // namespace R421A
@@ -0,0 +1,81 @@
+/**
+ * Modbus/R421A/VirtualSlave.h
+ *
+ * Copyright 2022 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the IOControl Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#pragma once
+
+#include "../VirtualSlave.h"
+#include "Device.h"
+
+namespace IO
+{
+namespace Modbus
+{
+namespace R421A
+{
+/**
+ * @brief Simulated R421A relay board
+ *
+ * Implements the query and relay commands, including open/close all.
+ * Momentary and delay commands are acknowledged but the timed pulse is not simulated.
+ * As with real boards, requests for channels outside the valid range are ignored.
+ */
+class VirtualSlave : public Modbus::VirtualSlave
+{
+public:
+	/**
+	 * @brief Construct a simulated relay board
+	 * @param address Slave address
+	 * @param channelCount Number of relays fitted, up to R421A_MAX_CHANNELS
+	 * @param segment Bus segment
+	 * @param config Serial settings, as configured for the device
+	 */
+	VirtualSlave(uint8_t address, uint8_t channelCount, uint8_t segment, const IO::Serial::Config& config)
+		: Modbus::VirtualSlave(address, segment, config), channelCount(std::min(channelCount, R421A_MAX_CHANNELS))
+	{
+	}
+
+	VirtualSlave(uint8_t address, uint8_t channelCount, uint8_t segment = 0)
+		: Modbus::VirtualSlave(address, segment), channelCount(std::min(channelCount, R421A_MAX_CHANNELS))
+	{
+	}
+
+	/**
+	 * @brief Get current relay states, bit 1 corresponds to channel 1
+	 */
+	BitSet32 getStates() const
+	{
+		return states;
+	}
+
+protected:
+	bool handleRequest(PDU& pdu) override;
+
+private:
+	bool isValid(uint16_t channel) const
+	{
+		return channel >= R421_CHANNEL_MIN && channel < R421_CHANNEL_MIN + channelCount;
+	}
+
+	uint8_t channelCount;
+	BitSet32 states;
+};
+
+} // namespace R421A
+} // namespace Modbus
+} // namespace IO
@@ -0,0 +1,268 @@
+/**
+ * Device.h
+ *
+ * Copyright 2022 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the IOControl Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#pragma once
+
+#include "../Device.h"
+#include <memory>
+
+namespace IO
+{
+namespace Modbus
+{
+namespace RegisterMap
+{
+/**
+ * @brief Maximum number of points per device
+ */
+constexpr uint8_t MAX_POINTS{64};
+
+/**
+ * @brief Default number of unused registers allowed between points in the same read transaction
+ */
+constexpr uint16_t DEFAULT_GAP{4};
+
+/**
+ * @brief Bitmask of points or blocks
+ */
+using PointMask = uint64_t;
+
+/*
+ * Modbus data tables
+ */
+#define IOREGMAP_TABLE_MAP(XX)                                                                                         \
+	XX(coil, "Read/write single bit")                                                                                  \
+	XX(discrete, "Read-only single bit")                                                                               \
+	XX(input, "Read-only 16-bit register")                                                                             \
+	XX(holding, "Read/write 16-bit register")
+
+enum class Table {
+#define XX(tag, comment) tag,
+	IOREGMAP_TABLE_MAP(XX)
+#undef XX
+};
+
+String toString(Table table);
+bool fromString(Table& table, const char* str);
+
+/*
+ * Register value types, with number of registers occupied.
+ * 32-bit values are stored high word first.
+ */
+#define IOREGMAP_TYPE_MAP(XX)                                                                                          \
+	XX(u16, 1)                                                                                                         \
+	XX(s16, 1)                                                                                                         \
+	XX(u32, 2)                                                                                                         \
+	XX(s32, 2)                                                                                                         \
+	XX(f32, 2)
+
+enum class Type {
+#define XX(tag, size) tag,
+	IOREGMAP_TYPE_MAP(XX)
+#undef XX
+};
+
+String toString(Type type);
+bool fromString(Type& type, const char* str);
+
+/**
+ * @brief Describes a single value read from or written to a slave
+ *
+ * The engineering value is `raw * scale + offset`.
+ */
+struct Point {
+	CString name;
+	float scale{1};
+	float offset{0};
+	uint16_t address{0};
+	Table table{Table::holding};
+	Type type{Type::u16};
+
+	bool isBit() const
+	{
+		return table == Table::coil || table == Table::discrete;
+	}
+
+	bool isWritable() const
+	{
+		return table == Table::coil || table == Table::holding;
+	}
+
+	/**
+	 * @brief Number of registers (or bits) occupied
+	 */
+	uint8_t size() const;
+};
+
+/**
+ * @brief A range of registers (or bits) read in a single transaction
+ */
+struct Block {
+	PointMask points; ///< Points contained in this block
+	uint16_t address;
+	uint16_t count;
+	Table table;
+};
+
+/**
+ * @brief Generic Modbus slave described by a list of points
+ *
+ * Each point is a node, numbered from 0 in the order given in the configuration.
+ * Points are grouped into blocks so that a query reads all points with as few transactions as possible.
+ */
+class Device : public Modbus::Device
+{
+public:
+	class Factory : public IO::Device::Factory
+	{
+	public:
+		IO::Device* createDevice(IO::Controller& controller, const char* id) const override
+		{
+			return new Device(reinterpret_cast<RS485::Controller&>(controller), id);
+		}
+
+		const FlashString& controllerClass() const override
+		{
+			return RS485::CONTROLLER_CLASSNAME;
+		}
+
+		const FlashString& deviceClass() const override
+		{
+			DEFINE_FSTR_LOCAL(DEVICE_CLASSNAME, "regmap")
+			return DEVICE_CLASSNAME;
+		}
+
+		RequestPool* getRequestPool() const override;
+	};
+
+	static const Factory factory;
+
+	/**
+	 * @brief Register map device configuration
+	 */
+	struct Config {
+		Modbus::Device::Config modbus; ///< Basic modbus configuration
+		const Point* points;		   ///< Point definitions, copied by init()
+		uint8_t pointCount;
+		uint16_t gap; ///< Unused registers (or bits) permitted between points in one block
+	};
+
+	using Modbus::Device::Device;
+
+	ErrorCode init(const Config& config);
+	ErrorCode init(JsonObjectConst config) override;
+
+	IO::Request* createRequest() override;
+	RequestPool* getRequestPool() const override;
+
+	DevNode::ID nodeIdMin() const override
+	{
+		return 0;
+	}
+
+	DevNode::ID nodeIdMax() const override
+	{
+		return pointCount - 1;
+	}
+
+	uint16_t maxNodes() const override
+	{
+		return pointCount;
+	}
+
+	bool isValid(DevNode node) const
+	{
+		return node.id < pointCount;
+	}
+
+	DevNode::States getNodeStates(DevNode node) const override;
+
+	uint8_t getPointCount() const
+	{
+		return pointCount;
+	}
+
+	const Point& getPoint(uint8_t index) const
+	{
+		return points[index];
+	}
+
+	/**
+	 * @brief Find a point by name
+	 * @retval int Point index, -1 if not found
+	 */
+	int findPoint(const char* name) const;
+
+	uint8_t getBlockCount() const
+	{
+		return blockCount;
+	}
+
+	const Block& getBlock(uint8_t index) const
+	{
+		return blocks[index];
+	}
+
+	/**
+	 * @brief Get most recently read or written value for a point
+	 * @param index Point index
+	 * @param value (OUT)
+	 * @retval bool false if value has not been read
+	 */
+	bool getValue(uint8_t index, float& value) const
+	{
+		if(index >= pointCount || (validMask & (PointMask(1) << index)) == 0) {
+			return false;
+		}
+		value = values[index];
+		return true;
+	}
+
+	/**
+	 * @brief Update cached point value
+	 * @note Called by requests
+	 */
+	void setValue(uint8_t index, float value)
+	{
+		values[index] = value;
+		validMask |= PointMask(1) << index;
+	}
+
+	/**
+	 * @brief Get mask of blocks required to read a set of points
+	 */
+	PointMask getBlockMask(PointMask points) const;
+
+protected:
+	void parseJson(JsonObjectConst json, Config& cfg);
+
+private:
+	void planBlocks(uint16_t gap);
+
+	std::unique_ptr<Point[]> points;
+	std::unique_ptr<float[]> values;
+	std::unique_ptr<Block[]> blocks;
+	PointMask validMask{0};
+	uint8_t pointCount{0};
+	uint8_t blockCount{0};
+};
+
+} // namespace RegisterMap
+} // namespace Modbus
+} // namespace IO
@@ -0,0 +1,131 @@
+/**
+ * Request.h
+ *
+ * Copyright 2022 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the IOControl Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#pragma once
+
+#include "../Request.h"
+#include "Device.h"
+
+namespace IO
+{
+namespace Modbus
+{
+namespace RegisterMap
+{
+/**
+ * @brief Reads or writes points on a register map device
+ *
+ * A query reads all blocks containing the requested points, one transaction per block.
+ * The `set` command writes a value to each requested point, and `on`/`off` write 1/0.
+ */
+class Request : public Modbus::Request
+{
+public:
+	Request(Device& device) : Modbus::Request(device)
+	{
+	}
+
+	static RequestPool pool; ///< Shared by all devices of this class
+
+	static void* operator new(size_t size) noexcept
+	{
+		return pool.allocate(size);
+	}
+
+	static void operator delete(void* ptr)
+	{
+		pool.release(ptr);
+	}
+
+	ErrorCode parseJson(JsonObjectConst json) override;
+
+	void getJson(JsonObject json) const override;
+
+	const Device& getDevice() const
+	{
+		return static_cast<const Device&>(device);
+	}
+
+	bool setNode(DevNode node) override;
+
+	DevNode::States getNodeStates(DevNode node) override;
+
+	/**
+	 * @brief Set value to write to nodes
+	 */
+	bool nodeSet(DevNode node, float value)
+	{
+		setCommand(Command::set);
+		this->value = value;
+		return setNode(node);
+	}
+
+	/**
+	 * @brief Get points read or written by this request
+	 */
+	PointMask getResponse() const
+	{
+		return response;
+	}
+
+	Merge checkMerge(const IO::Request& other) const override;
+	void copyResult(const IO::Request& other) override;
+
+	bool canWriteBehind() const override;
+
+	Function fillRequestData(PDU::Data& data) override;
+	ErrorCode callback(PDU& pdu) override;
+
+private:
+	Device& getDevice()
+	{
+		return static_cast<Device&>(device);
+	}
+
+	bool isWrite() const
+	{
+		auto cmd = getCommand();
+		return cmd == Command::set || cmd == Command::on || cmd == Command::off;
+	}
+
+	float writeValue() const
+	{
+		switch(getCommand()) {
+		case Command::on:
+			return 1;
+		case Command::off:
+			return 0;
+		default:
+			return value;
+		}
+	}
+
+	Function fillWriteData(PDU::Data& data);
+	void readBlock(const Block& block, const PDU& pdu);
+
+	PointMask nodeMask{0}; ///< Points requested
+	PointMask pending{0};  ///< Blocks still to read, or points still to write
+	PointMask response{0}; ///< Points read or written
+	float value{0};
+	int8_t activeIndex{-1}; ///< Block or point for current transaction
+};
+
+} // namespace RegisterMap
+} // namespace Modbus
+} // namespace IO
@@ -0,0 +1,100 @@
+/**
+ * Modbus/RegisterMap/VirtualSlave.h
+ *
+ * Copyright 2022 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the IOControl Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#pragma once
+
+#include "../VirtualSlave.h"
+#include "Device.h"
+
+namespace IO
+{
+namespace Modbus
+{
+namespace RegisterMap
+{
+/**
+ * @brief Simulated generic Modbus slave with all four data tables
+ *
+ * Each table holds the same number of entries, starting at address 0.
+ * Bit tables use a full word per entry for simplicity.
+ * Requests outside the table range fail with `IllegalDataAddress`.
+ */
+class VirtualSlave : public Modbus::VirtualSlave
+{
+public:
+	/**
+	 * @brief Construct a simulated slave
+	 * @param address Slave address
+	 * @param size Number of entries in each table
+	 * @param segment Bus segment
+	 * @param config Serial settings, as configured for the device
+	 */
+	VirtualSlave(uint8_t address, uint16_t size, uint8_t segment, const IO::Serial::Config& config)
+		: Modbus::VirtualSlave(address, segment, config), data(new uint16_t[TABLE_COUNT * size]{}), size(size)
+	{
+	}
+
+	VirtualSlave(uint8_t address, uint16_t size, uint8_t segment = 0)
+		: Modbus::VirtualSlave(address, segment), data(new uint16_t[TABLE_COUNT * size]{}), size(size)
+	{
+	}
+
+	/**
+	 * @brief Get a register or bit value
+	 * @retval uint16_t 0 if address is out of range
+	 */
+	uint16_t getValue(Table table, uint16_t address) const
+	{
+		return (address < size) ? data[unsigned(table) * size + address] : 0;
+	}
+
+	/**
+	 * @brief Set a register or bit value, including read-only tables
+	 * @retval bool false if address is out of range
+	 */
+	bool setValue(Table table, uint16_t address, uint16_t value)
+	{
+		if(address >= size) {
+			return false;
+		}
+		data[unsigned(table) * size + address] = (table == Table::coil || table == Table::discrete) ? (value != 0) : value;
+		return true;
+	}
+
+protected:
+	bool handleRequest(PDU& pdu) override;
+
+private:
+	static constexpr unsigned TABLE_COUNT{4};
+
+	bool isValid(uint16_t address, uint16_t count) const
+	{
+		return count != 0 && address < size && count <= size - address;
+	}
+
+	bool readBits(Table table, PDU& pdu);
+	bool readRegisters(Table table, PDU& pdu);
+
+	std::unique_ptr<uint16_t[]> data;
+	uint16_t size;
+};
+
+} // namespace RegisterMap
+} // namespace Modbus
+} // namespace IO
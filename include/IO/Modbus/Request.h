@@ -41,6 +41,38 @@ public:
 		return reinterpret_cast<const Device&>(device);
 	}
 
+	ErrorCode parseJson(JsonObjectConst json) override;
+
+	/**
+	 * @brief Determine whether this request may be held in the device's write-behind cache
+	 *
+	 * Only requests which write plain values to holding registers qualify, using a single
+	 * `WriteSingleRegister` or `WriteMultipleRegisters` transaction.
+	 * Commands such as relay operations, where two writes don't have the same effect as the last one, must not.
+	 */
+	virtual bool canWriteBehind() const
+	{
+		return false;
+	}
+
+	/**
+	 * @brief Send request to all slaves on the bus
+	 *
+	 * Only write functions may be broadcast. Slaves don't respond, so the request completes
+	 * once transmitted plus a turnaround delay (see `BROADCAST_TURNAROUND_DELAY`) to allow them to act on it.
+	 * The callback receives the normal (echo) response, so the issuing device's state is
+	 * updated as though it had responded.
+	 */
+	void setBroadcast(bool state)
+	{
+		broadcast = state;
+	}
+
+	bool isBroadcast() const
+	{
+		return broadcast;
+	}
+
 	virtual Function fillRequestData(PDU::Data& data) = 0;
 
 	/**
@@ -50,6 +82,9 @@ public:
 	 * otherwise request will be completed with given error.
 	 */
 	virtual ErrorCode callback(PDU& pdu) = 0;
+
+private:
+	bool broadcast{false};
 };
 
 } // namespace Modbus
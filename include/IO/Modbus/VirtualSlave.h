@@ -0,0 +1,80 @@
+/**
+ * Modbus/VirtualSlave.h
+ *
+ * Copyright 2022 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the IOControl Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#pragma once
+
+#include "../Virtual/Bus.h"
+#include "ADU.h"
+
+namespace IO
+{
+namespace Modbus
+{
+/**
+ * @brief Base class for simulated Modbus RTU slaves
+ *
+ * Frames are checked for address and CRC before being passed to handleRequest().
+ * Broadcast requests are processed but not answered.
+ */
+class VirtualSlave : public Virtual::Slave
+{
+public:
+	struct Stats {
+		uint32_t requests; ///< Requests addressed to this slave, including broadcasts
+		uint32_t errors;   ///< Frames which failed CRC or size checks
+	};
+
+	VirtualSlave(uint8_t address, uint8_t segment, const IO::Serial::Config& config)
+		: Slave(segment, config), address(address)
+	{
+	}
+
+	VirtualSlave(uint8_t address, uint8_t segment = 0) : Slave(segment), address(address)
+	{
+	}
+
+	size_t receive(const uint8_t* data, size_t size, uint8_t* response) override;
+
+	uint8_t getAddress() const
+	{
+		return address;
+	}
+
+	const Stats& getStats() const
+	{
+		return stats;
+	}
+
+protected:
+	/**
+	 * @brief Implement this method to process a request
+	 * @param pdu On entry contains request, on return contains response
+	 * @retval bool true to respond, false to remain silent
+	 *
+	 * Use `pdu.setException()` to report an error.
+	 */
+	virtual bool handleRequest(PDU& pdu) = 0;
+
+private:
+	uint8_t address;
+	Stats stats{};
+};
+
+} // namespace Modbus
+} // namespace IO
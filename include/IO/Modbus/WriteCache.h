@@ -0,0 +1,96 @@
+/**
+ * Modbus/WriteCache.h
+ *
+ * Copyright 2022 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the IOControl Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#pragma once
+
+#include "Function.h"
+#include "../Request.h"
+#include "../Clock.h"
+
+namespace IO
+{
+namespace Modbus
+{
+class Device;
+class Request;
+
+/**
+ * @brief Write-behind cache for holding register writes
+ *
+ * Qualifying requests (see `Request::canWriteBehind()`) aren't queued but merged into a flush request
+ * which the controller holds for up to a configured window. A later write to the same register replaces the held value.
+ * When the window expires the dirty registers are written in as few transactions as possible,
+ * contiguous registers being combined into a single `WriteMultipleRegisters`.
+ * All requests absorbed into the cache complete when that write completes.
+ *
+ * Held writes may be cancelled as usual. Those cancelled, or past their deadline when the flush executes,
+ * are left out of it.
+ *
+ * The cache is also flushed ahead of any other request for the device, so reads and
+ * non-cacheable writes see the same ordering as if writes were sent immediately.
+ */
+class WriteCache
+{
+public:
+	static constexpr size_t MAX_REGISTERS{16}; ///< Dirty registers held before an early flush
+	static constexpr size_t MAX_WAITERS{8};	///< Absorbed requests held before an early flush
+
+	/**
+	 * @brief Construct a cache
+	 * @param window Maximum time (ms) to hold a write
+	 */
+	WriteCache(Device& device, uint16_t window);
+
+	WriteCache(const WriteCache&) = delete;
+
+	~WriteCache();
+
+	/**
+	 * @brief Offer a newly submitted request to the cache
+	 * @retval bool true if request has been absorbed, false if it should be queued as usual
+	 */
+	bool submit(Request& request);
+
+	/**
+	 * @brief Write all dirty registers now
+	 * @param priority Minimum priority for the write
+	 */
+	void flush(Priority priority = Priority::background);
+
+	uint16_t getWindow() const
+	{
+		return window;
+	}
+
+	/**
+	 * @brief Get number of registers waiting to be written
+	 */
+	unsigned getDirtyCount() const;
+
+private:
+	class FlushRequest;
+
+	Device& device;
+	FlushRequest* pending{nullptr}; ///< Held by controller until flushed
+	ClockTimer timer;
+	uint16_t window;
+};
+
+} // namespace Modbus
+} // namespace IO
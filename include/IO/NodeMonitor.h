@@ -0,0 +1,142 @@
+/**
+ * NodeMonitor.h
+ *
+ * Copyright 2022 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the IOControl Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#pragma once
+
+#include "DevNode.h"
+#include "ListenerList.h"
+#include <Delegate.h>
+#include <Data/LinkedObjectList.h>
+#include <Data/CString.h>
+#include <WVector.h>
+#include <memory>
+
+namespace IO
+{
+class Device;
+
+/**
+ * @brief A change in state of a device node
+ */
+struct NodeChange {
+	Device* device;
+	DevNode node;
+	DevNode::State state;
+};
+
+using NodeChangeList = Vector<NodeChange>;
+
+/**
+ * @brief Notifies subscribers when device node states change
+ *
+ * Devices are checked after each request completes. Checks are deferred to the next
+ * event loop tick so that all changes in that time are reported together:
+ * a query which updates eight channels produces one notification.
+ *
+ * Node states are compared with those last reported, so only actual changes are notified.
+ * The first notification for a device includes all nodes with a known state.
+ *
+ * Subscriptions refer to devices by ID so they remain valid when the configuration is reloaded.
+ */
+class NodeMonitor
+{
+public:
+	/**
+	 * @brief Callback invoked with all changes matching a subscription's filter
+	 */
+	using Callback = Delegate<void(const NodeChangeList& changes)>;
+
+	/**
+	 * @brief Subscribe to node state changes
+	 * @param device Device to monitor, nullptr for all devices
+	 * @param node Node to monitor, DevNode_ALL for all nodes
+	 * @param callback
+	 * @retval uint16_t Subscription identifier, 0 on failure
+	 */
+	uint16_t subscribe(const Device* device, DevNode node, Callback callback);
+
+	/**
+	 * @brief Cancel a subscription
+	 * @param id Value returned from subscribe()
+	 * @retval bool false if subscription not found
+	 */
+	bool unsubscribe(uint16_t id);
+
+	/**
+	 * @brief Called when a request for a device completes
+	 */
+	void deviceUpdated(Device& device);
+
+	/**
+	 * @brief Discard recorded states, e.g. when devices are created or destroyed
+	 */
+	void reset()
+	{
+		devices.clear();
+	}
+
+private:
+	class Subscription : public ListenerList<Subscription>::Item
+	{
+	public:
+		bool matches(const Device& device) const;
+
+		bool matches(const NodeChange& change) const
+		{
+			return matches(*change.device) && (node == DevNode_ALL || node == change.node);
+		}
+
+		Callback callback;
+		CString deviceId; ///< Empty for all devices
+		DevNode node;
+	};
+
+	/**
+	 * @brief Node states last reported for a device
+	 */
+	class DeviceStates : public LinkedObjectTemplate<DeviceStates>
+	{
+	public:
+		using OwnedList = OwnedLinkedObjectListTemplate<DeviceStates>;
+
+		DeviceStates(Device& device) : device(device)
+		{
+		}
+
+		void getChanges(NodeChangeList& changes);
+
+		Device& device;
+		std::unique_ptr<DevNode::State[]> states;
+		uint16_t count{0};
+		bool changed{false}; ///< Device updated since last check
+	};
+
+	static void notifyStatic(void* param)
+	{
+		static_cast<NodeMonitor*>(param)->notify();
+	}
+
+	void notify();
+
+	ListenerList<Subscription> subscriptions;
+	DeviceStates::OwnedList devices;
+	bool scheduled{false}; ///< notify() is queued
+};
+
+} // namespace IO
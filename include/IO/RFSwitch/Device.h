@@ -65,6 +65,8 @@ public:
 			DEFINE_FSTR_LOCAL(DEVICE_CLASSNAME, "rfswitch")
 			return DEVICE_CLASSNAME;
 		}
+
+		RequestPool* getRequestPool() const override;
 	};
 
 	static const Factory factory;
@@ -88,6 +90,7 @@ public:
 	}
 
 	IO::Request* createRequest() override;
+	RequestPool* getRequestPool() const override;
 
 	const Timing& getTiming() const
 	{
@@ -40,6 +40,18 @@ public:
 		setCommand(Command::set);
 	}
 
+	static RequestPool pool; ///< Shared by all devices of this class
+
+	static void* operator new(size_t size) noexcept
+	{
+		return pool.allocate(size);
+	}
+
+	static void operator delete(void* ptr)
+	{
+		pool.release(ptr);
+	}
+
 	const Device& getDevice() const
 	{
 		return reinterpret_cast<const Device&>(device);
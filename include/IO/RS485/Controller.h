@@ -21,7 +21,8 @@
 
 #include "../Controller.h"
 #include "../Serial.h"
-#include <SimpleTimer.h>
+#include "../Clock.h"
+#include "../DMX512/Universe.h"
 
 namespace IO
 {
@@ -43,6 +44,7 @@ public:
 
 	void start() override;
 	void stop() override;
+	void freeDevices() override;
 
 	/**
 	 * @brief Callback to handle hardware transmit/receive selection
@@ -83,6 +85,13 @@ public:
 		return serial;
 	}
 
+	/**
+	 * @brief Get the DMX512 output frame for this port, creating it if required
+	 * @retval Universe* nullptr if out of memory
+	 * @note The frame is discarded along with the devices
+	 */
+	DMX512::Universe* getDmxUniverse();
+
 	void handleEvent(Request* request, Event event) override;
 
 	using OnRequestDelegate = Delegate<void(Controller& controller)>;
@@ -94,12 +103,64 @@ public:
 
 	void setSegment(uint8_t segment)
 	{
-		this->segment = segment;
+		if(segment != this->segment) {
+			this->segment = segment;
+			++reconfigCount;
+		}
+	}
+
+	/**
+	 * @brief Set serial port configuration for the current request
+	 *
+	 * The port isn't reprogrammed if the settings are unchanged.
+	 * The original settings are restored once the queue is empty.
+	 */
+	void setConfig(const Serial::Config& config)
+	{
+		if(!(config == serial.getConfig())) {
+			serial.setConfig(config);
+			++reconfigCount;
+		}
+	}
+
+	/**
+	 * @brief Get the number of times the segment or serial settings have been changed
+	 */
+	uint32_t getReconfigCount() const
+	{
+		return reconfigCount;
+	}
+
+	void resetReconfigCount()
+	{
+		reconfigCount = 0;
 	}
 
 	void send(const void* data, size_t size);
 
+	/**
+	 * @brief Restart the transaction timer for the current request
+	 * @param ms Time until `Event::Timeout` is raised
+	 */
+	void setTimeout(uint32_t ms)
+	{
+		timer.setIntervalMs(ms);
+		timer.startOnce();
+	}
+
+	/**
+	 * @brief Set size of expected response so receive completes as soon as it arrives
+	 * @param size Size of packet in bytes, 0 if unknown
+	 *
+	 * Must be called before send(). If size is unknown, or a shorter packet is received,
+	 * receive completes when the line goes idle.
+	 */
+	void expectResponse(size_t size);
+
 protected:
+	bool isSameLink(const Request& request) const override;
+	void startExecution(Request& request) override;
+
 	virtual void handleIncomingRequest()
 	{
 		if(requestCallback) {
@@ -108,7 +169,7 @@ protected:
 	}
 
 private:
-	static void IRAM_ATTR uartCallbackStatic(smg_uart_t* uart, uint32_t status);
+	static void IRAM_ATTR serialCallback(void* param, uint32_t status);
 	void IRAM_ATTR uartCallback(uint32_t status);
 	void receiveComplete();
 
@@ -117,10 +178,16 @@ private:
 	SetDirectionCallback setDirectionCallback{nullptr};
 	Request* request{nullptr};				   ///< Current outgoing request (if any)
 	Request* transmitCompleteRequest{nullptr}; ///< Captured request for transmit complete callback
+	Request* deferredRequest{nullptr};		   ///< Request waiting for the inter-frame gap to elapse
 	uint8_t segment{0};						   ///< Active bus segment
+	uint16_t expectedSize{0};				   ///< Size of expected response, 0 if unknown
+	uint32_t lastActivity{0};				   ///< Time (us) of last transmit or receive completion
+	uint32_t reconfigCount{0};
 	OnRequestDelegate requestCallback;
-	SimpleTimer timer; ///< Use to schedule callback and timeout
-	Serial::Config savedConfig{};
+	ClockTimer timer; ///< Use to schedule callback and timeout
+	Serial::Config savedConfig{}; ///< Settings to restore when idle
+	bool configSaved{false};
+	std::unique_ptr<DMX512::Universe> dmxUniverse;
 };
 
 } // namespace RS485
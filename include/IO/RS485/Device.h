@@ -21,6 +21,7 @@
 
 #include "../Device.h"
 #include "Controller.h"
+#include "RttEstimator.h"
 
 namespace IO
 {
@@ -28,6 +29,16 @@ namespace RS485
 {
 constexpr unsigned DEFAULT_BAUDRATE = 9600;
 
+/**
+ * @brief Default maximum time to wait for a response, in milliseconds
+ */
+constexpr unsigned DEFAULT_TIMEOUT = 800;
+
+/**
+ * @brief Lower limit for adaptive timeouts, in milliseconds
+ */
+constexpr unsigned ADAPTIVE_TIMEOUT_MIN = 20;
+
 /**
  * @brief Base device class for communicating with an RS485 slave
  */
@@ -60,6 +71,10 @@ public:
 			 * Max time between command/response in milliseconds.
 			 */
 			unsigned timeout;
+			/**
+			 * Adjust timeout according to observed response times, up to `timeout`
+			 */
+			bool adaptive;
 		};
 		Slave slave;
 	};
@@ -91,6 +106,35 @@ public:
 		return slaveConfig.baudrate ?: DEFAULT_BAUDRATE;
 	}
 
+	/**
+	 * @brief Get the serial settings used to communicate with this device
+	 */
+	virtual Serial::Config getSerialConfig() const
+	{
+		return Serial::Config{
+			.baudrate = baudrate(),
+			.format = UART_8N1,
+		};
+	}
+
+	/**
+	 * @brief Get time to wait for a response to the current request
+	 * @retval unsigned Timeout in milliseconds
+	 */
+	unsigned timeout() const
+	{
+		unsigned maxTimeout = slaveConfig.timeout ?: DEFAULT_TIMEOUT;
+		return slaveConfig.adaptive ? rtt.getTimeout(ADAPTIVE_TIMEOUT_MIN, maxTimeout) : maxTimeout;
+	}
+
+	/**
+	 * @brief Get round-trip time measurements for this device
+	 */
+	const RttEstimator& getRtt() const
+	{
+		return rtt;
+	}
+
 	void handleEvent(IO::Request* request, Event event) override;
 
 protected:
@@ -98,6 +142,8 @@ protected:
 
 private:
 	Config::Slave slaveConfig;
+	RttEstimator rtt;
+	uint32_t executeTime{0}; ///< When current transaction started
 };
 
 } // namespace RS485
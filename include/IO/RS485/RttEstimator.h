@@ -0,0 +1,118 @@
+/**
+ * RttEstimator.h
+ *
+ * Copyright 2022 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the IOControl Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#pragma once
+
+#include <cstdint>
+#include <algorithm>
+#include <cstdlib>
+
+namespace IO
+{
+namespace RS485
+{
+/**
+ * @brief Tracks the round-trip time for a slave and derives a response timeout from it
+ *
+ * Uses the smoothed RTT and mean deviation estimators from RFC 6298, in fixed-point integer arithmetic.
+ * The timeout is doubled for each consecutive timeout (up to a limit) and reset by the next good response.
+ */
+class RttEstimator
+{
+public:
+	static constexpr uint8_t maxBackoff{4};
+
+	/**
+	 * @brief Record a measured round-trip time
+	 * @param rtt Time in milliseconds
+	 */
+	void update(uint32_t rtt)
+	{
+		if(srtt8 == 0) {
+			srtt8 = std::max(rtt, uint32_t(1)) << 3;
+			rttvar4 = rtt << 1;
+		} else {
+			int32_t err = int32_t(rtt) - int32_t(srtt8 >> 3);
+			srtt8 = std::max(int32_t(srtt8) + err, int32_t(8));
+			rttvar4 += std::abs(err) - int32_t(rttvar4 >> 2);
+		}
+		backoff = 0;
+	}
+
+	/**
+	 * @brief Record a failure to respond
+	 */
+	void timedOut()
+	{
+		if(backoff < maxBackoff) {
+			++backoff;
+		}
+	}
+
+	/**
+	 * @brief Determine if any measurements have been made
+	 */
+	bool isValid() const
+	{
+		return srtt8 != 0;
+	}
+
+	/**
+	 * @brief Smoothed round-trip time in milliseconds
+	 */
+	uint32_t getSmoothed() const
+	{
+		return srtt8 >> 3;
+	}
+
+	/**
+	 * @brief Mean deviation of round-trip time in milliseconds
+	 */
+	uint32_t getVariation() const
+	{
+		return rttvar4 >> 2;
+	}
+
+	/**
+	 * @brief Get recommended timeout
+	 * @param minTimeout Lower bound, milliseconds
+	 * @param maxTimeout Upper bound, milliseconds. Returned if no measurements have been made.
+	 */
+	uint32_t getTimeout(uint32_t minTimeout, uint32_t maxTimeout) const
+	{
+		if(!isValid()) {
+			return maxTimeout;
+		}
+		uint32_t rto = ((srtt8 >> 3) + rttvar4) << backoff;
+		return std::min(std::max(rto, minTimeout), maxTimeout);
+	}
+
+	void reset()
+	{
+		*this = RttEstimator{};
+	}
+
+private:
+	uint32_t srtt8{0};   ///< Smoothed RTT x 8
+	uint32_t rttvar4{0}; ///< RTT variation x 4
+	uint8_t backoff{0};  ///< Number of consecutive timeouts
+};
+
+} // namespace RS485
+} // namespace IO
@@ -48,9 +48,34 @@ enum class Command {
 #undef XX
 };
 
+#define XX(tag, comment) +1
+constexpr unsigned COMMAND_COUNT{0 IOCOMMAND_MAP(XX)};
+#undef XX
+
 String toString(Command cmd);
 bool fromString(Command& cmd, const char* str);
 
+/*
+ * Request priority levels, lowest first
+ */
+#define IOPRIORITY_MAP(XX)                                                                                             \
+	XX(background, "Housekeeping such as device start-up queries and polling")                                         \
+	XX(normal, "Default priority")                                                                                     \
+	XX(interactive, "User-initiated commands")
+
+enum class Priority {
+#define XX(tag, comment) tag,
+	IOPRIORITY_MAP(XX)
+#undef XX
+};
+
+#define XX(tag, comment) +1
+constexpr unsigned PRIORITY_COUNT{0 IOPRIORITY_MAP(XX)};
+#undef XX
+
+String toString(Priority priority);
+bool fromString(Priority& priority, const char* str);
+
 class Device;
 class Request;
 
@@ -74,7 +99,10 @@ class Request;
  */
 class Request : public LinkedObjectTemplate<Request>
 {
+	friend class Controller;
+
 public:
+	using List = LinkedObjectListTemplate<Request>;
 	using OwnedList = OwnedLinkedObjectListTemplate<Request>;
 
 	/**
@@ -92,6 +120,28 @@ public:
 	 */
 	using Callback = Delegate<void(const Request& request)>;
 
+	/**
+	 * @brief Times (us) at which a request reached each stage of processing, 0 if not yet reached
+	 *
+	 * For requests performing several transactions, `execute` is when the first started
+	 * and `transmit`/`receive` refer to the most recent.
+	 */
+	struct Timing {
+		uint32_t submit;   ///< Queued by controller
+		uint32_t execute;  ///< Execution started
+		uint32_t transmit; ///< Request transmitted
+		uint32_t receive;  ///< Response received
+	};
+
+	/**
+	 * @brief How a newly submitted request relates to one already queued for the same device
+	 */
+	enum class Merge {
+		none,	  ///< Requests are independent
+		duplicate, ///< New request would perform an identical transaction, so can share the queued one
+		supersede, ///< New request makes the queued one redundant, so the queued one need not execute
+	};
+
 	Request(Device& device) : device(device)
 	{
 		debug_d("Request %p created", this);
@@ -137,6 +187,15 @@ public:
 	 */
 	virtual void submit();
 
+	/**
+	 * @brief Withdraw a submitted request
+	 * @retval bool true if request was waiting and has been completed with `Error::cancelled`,
+	 * false if it is executing or has not been submitted
+	 *
+	 * @note If successful the request object is destroyed before this method returns.
+	 */
+	bool cancel();
+
 	/*
 	 * Usually called by device or controller, but can also be used to
 	 * pass a request to its callback first, for example on a configuration
@@ -166,6 +225,38 @@ public:
 		command = cmd;
 	}
 
+	/**
+	 * @brief Set the request priority
+	 *
+	 * The controller always executes the highest-priority request next.
+	 * Requests which have been queued for a while are aged up so lower priority work doesn't starve.
+	 */
+	void setPriority(Priority priority)
+	{
+		this->priority = priority;
+	}
+
+	Priority getPriority() const
+	{
+		return priority;
+	}
+
+	/**
+	 * @brief Set the maximum time a request may wait in the queue
+	 * @param ms Time in milliseconds from submission, 0 for no limit
+	 *
+	 * A request which hasn't started executing by this time is completed with `Error::timeout`.
+	 */
+	void setDeadline(uint32_t ms)
+	{
+		deadline = ms;
+	}
+
+	uint32_t getDeadline() const
+	{
+		return deadline;
+	}
+
 	/**
 	 * @brief Set the request completion callback
 	 */
@@ -251,18 +342,90 @@ public:
 		return command;
 	}
 
+	const Timing& getTiming() const
+	{
+		return timing;
+	}
+
 	/**
 	 * @brief Implementations may override this method as required
 	 */
 	virtual void handleEvent(Event event);
 
+	/**
+	 * @brief Determine whether this request can be merged with one already queued
+	 * @param other A queued, unexecuted request for the same device
+	 *
+	 * Called by the controller when this request is submitted.
+	 * Merged requests complete together, and the callback for each is invoked.
+	 *
+	 * @note Devices may queue internal requests of a different class, such as `Modbus::WriteCache` flushes.
+	 * These have an undefined command, so check the command before accessing class-specific data.
+	 */
+	virtual Merge checkMerge(const Request& other) const
+	{
+		return Merge::none;
+	}
+
+	/**
+	 * @brief Called on completion of a merged request to obtain the result
+	 * @param other The request which was actually executed
+	 */
+	virtual void copyResult(const Request& other)
+	{
+	}
+
 	Device& device;
 
+protected:
+	/**
+	 * @brief Get the requests which complete with this one
+	 */
+	List& getMerged()
+	{
+		return merged;
+	}
+
 private:
+	/**
+	 * @brief Attach a request to complete along with this one
+	 */
+	void merge(Request* other);
+
+	/**
+	 * @brief Detach a merged request
+	 * @retval bool false if request isn't merged with this one
+	 */
+	bool unmerge(Request* other);
+
+	bool isExpired(uint32_t now) const
+	{
+		return deadline != 0 && (now - queueTime) >= deadline;
+	}
+
+	/**
+	 * @brief Determine whether this request's deadline falls before that of another
+	 */
+	bool expiresBefore(const Request& other) const
+	{
+		if(deadline == 0) {
+			return false;
+		}
+		if(other.deadline == 0) {
+			return true;
+		}
+		return int32_t((queueTime + deadline) - (other.queueTime + other.deadline)) < 0;
+	}
+
+	OwnedList merged; ///< Requests which complete with this one
 	Callback callback;
+	Timing timing{};
 	Command command{Command::undefined}; ///< Active command
 	ErrorCode errorCode{Error::pending};
-	CString requestId; ///< User assigned request ID
+	CString requestId;		///< User assigned request ID
+	uint32_t queueTime{0};	///< System time (ms) when request was queued
+	uint32_t deadline{0};	 ///< Maximum time (ms) to wait in queue
+	Priority priority{Priority::normal};
 };
 
 } // namespace IO
@@ -0,0 +1,129 @@
+/**
+ * RequestPool.h
+ *
+ * Copyright 2022 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the IOControl Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#pragma once
+
+#include "Error.h"
+#include <ArduinoJson.h>
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+
+namespace IO
+{
+/**
+ * @brief Fixed-capacity block allocator for Request objects
+ *
+ * Each device class has a pool which its Request class draws from via `operator new`.
+ * All blocks are carved out of a single allocation made when the capacity is set,
+ * so sustained request traffic doesn't churn or fragment the heap.
+ *
+ * A pool with zero capacity (the default) passes allocations through to the heap.
+ */
+class RequestPool
+{
+public:
+	struct Stats {
+		uint16_t capacity;  ///< Number of blocks in the pool
+		uint16_t used;		///< Number of blocks currently allocated
+		uint16_t highWater; ///< Peak value of `used`
+		uint32_t hits;		///< Allocations served from the pool
+		uint32_t misses;	///< Allocations refused because the pool was exhausted
+	};
+
+	/**
+	 * @brief Construct a pool
+	 * @param blockSize Size of the Request class this pool serves
+	 */
+	RequestPool(size_t blockSize) : blockSize(alignSize(blockSize))
+	{
+	}
+
+	RequestPool(const RequestPool&) = delete;
+
+	/**
+	 * @brief Set the number of requests the pool can hold
+	 * @param capacity Number of blocks; 0 disables the pool so requests are allocated from the heap
+	 * @retval ErrorCode Fails with `Error::busy` if any blocks are in use
+	 */
+	ErrorCode setCapacity(uint16_t capacity);
+
+	/**
+	 * @brief Allocate storage for a request
+	 * @param size Size of object to allocate
+	 * @retval void* nullptr if pool is exhausted
+	 */
+	void* allocate(size_t size);
+
+	/**
+	 * @brief Return storage to the pool
+	 */
+	void release(void* ptr);
+
+	/**
+	 * @brief Determine if a pool is in use and has no free blocks
+	 */
+	bool isExhausted() const
+	{
+		return stats.capacity != 0 && freeList == nullptr;
+	}
+
+	const Stats& getStats() const
+	{
+		return stats;
+	}
+
+	/**
+	 * @brief Clear hit/miss counters and reset high-water mark to current usage
+	 */
+	void resetStats()
+	{
+		stats.highWater = stats.used;
+		stats.hits = 0;
+		stats.misses = 0;
+	}
+
+	/**
+	 * @brief Write pool statistics in JSON format
+	 */
+	void getJson(JsonObject json) const;
+
+private:
+	struct Block {
+		Block* next;
+	};
+
+	static constexpr size_t alignSize(size_t size)
+	{
+		return (std::max(size, sizeof(Block)) + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+	}
+
+	bool contains(const void* ptr) const
+	{
+		auto p = static_cast<const uint8_t*>(ptr);
+		return storage && p >= storage.get() && p < storage.get() + stats.capacity * blockSize;
+	}
+
+	std::unique_ptr<uint8_t[]> storage;
+	Block* freeList{nullptr};
+	size_t blockSize;
+	Stats stats{};
+};
+
+} // namespace IO
@@ -28,13 +28,39 @@ namespace IO
  * @brief Wrapper class for the UART driver
  *
  * RS485 requires efficient burst transfer access to the serial hardware, so uses the UART driver directly.
+ *
+ * Methods are virtual so an alternative transport may be substituted, such as IO::Virtual::Serial.
  */
 class Serial
 {
 public:
+	/**
+	 * @brief Called on transmit/receive events, typically in interrupt context
+	 * @param param As passed to setCallback()
+	 * @param status Combination of UART_STATUS_xxx bits
+	 */
+	using Callback = void (*)(void* param, uint32_t status);
+
 	struct Config {
 		uint32_t baudrate;
 		smg_uart_format_t format;
+
+		bool operator==(const Config& other) const
+		{
+			return baudrate == other.baudrate && format == other.format;
+		}
+	};
+
+	/**
+	 * @brief Line timing derived from baud rate and format, in microseconds
+	 *
+	 * Above 19200 baud Modbus specifies fixed values for the inter-character (t1.5)
+	 * and inter-frame (t3.5) gaps.
+	 */
+	struct Timing {
+		uint32_t charTime;  ///< Time to send one character
+		uint32_t charGap;   ///< t1.5: Maximum gap between characters within a frame
+		uint32_t frameGap;  ///< t3.5: Minimum silent interval between frames
 	};
 
 	virtual ~Serial()
@@ -45,12 +71,12 @@ public:
 	/**
 	 * @brief Initialise the serial port with a default configuration
 	 */
-	ErrorCode open(uint8_t uart_nr);
+	virtual ErrorCode open(uint8_t uart_nr);
 
 	/**
 	 * @brief Close the port
 	 */
-	void close();
+	virtual void close();
 
 	/**
 	 * @brief Set required buffer sizes
@@ -61,34 +87,51 @@ public:
 	 * @param txSize
 	 * @retval bool true on success
 	 */
-	bool resizeBuffers(size_t rxSize, size_t txSize);
+	virtual bool resizeBuffers(size_t rxSize, size_t txSize);
 
-	void setCallback(smg_uart_callback_t callback, void* param)
+	virtual void setCallback(Callback callback, void* param);
+
+	virtual void setBreak(bool state)
 	{
-		smg_uart_set_callback(uart, callback, param);
+		smg_uart_set_break(uart, state);
 	}
 
-	void setBreak(bool state)
+	/**
+	 * @brief Get number of bytes waiting in receive buffer
+	 */
+	virtual size_t available()
 	{
-		smg_uart_set_break(uart, state);
+		return smg_uart_rx_available(uart);
 	}
 
-	size_t read(void* buffer, size_t size)
+	/**
+	 * @brief Set number of bytes received before FIFO full interrupt fires
+	 * @param threshold Use 0 to restore the default
+	 *
+	 * Allows a receive to be completed without waiting for the idle timeout
+	 * if the size of the incoming packet is known.
+	 *
+	 * @note The interrupt causes a callback but the driver doesn't report `UART_STATUS_RXFIFO_FULL`
+	 * unless its receive buffer is full, so use `available()` to check how much data has arrived.
+	 */
+	virtual void setRxFullThreshold(uint8_t threshold);
+
+	virtual size_t read(void* buffer, size_t size)
 	{
 		return smg_uart_read(uart, buffer, size);
 	}
 
-	size_t write(const void* data, size_t len)
+	virtual size_t write(const void* data, size_t len)
 	{
 		return smg_uart_write(uart, data, len);
 	}
 
-	void swap(uint8_t txPin = 1)
+	virtual void swap(uint8_t txPin = 1)
 	{
 		smg_uart_swap(uart, txPin);
 	}
 
-	void clear(smg_uart_mode_t mode = UART_FULL)
+	virtual void clear(smg_uart_mode_t mode = UART_FULL)
 	{
 		smg_uart_flush(uart, mode);
 	}
@@ -98,11 +141,43 @@ public:
 		return activeConfig;
 	}
 
-	void setConfig(const Config& cfg);
+	/**
+	 * @brief Set baud rate and format
+	 *
+	 * Receive idle timeout is programmed to the inter-frame gap for the new settings.
+	 */
+	virtual void setConfig(const Config& cfg);
+
+	const Timing& getTiming() const
+	{
+		return timing;
+	}
+
+	/**
+	 * @brief Compute line timing for a configuration
+	 */
+	static Timing calculateTiming(const Config& cfg);
+
+protected:
+	void updateTiming();
+
+	void IRAM_ATTR notify(uint32_t status)
+	{
+		if(callback != nullptr) {
+			callback(callbackParam, status);
+		}
+	}
 
-private:
 	Config activeConfig{9600, UART_8N1};
+
+private:
+	static void IRAM_ATTR uartCallback(smg_uart_t* uart, uint32_t status);
+
+	smg_uart_intr_config_t intrConfig{};
+	Timing timing{};
 	smg_uart_t* uart{nullptr};
+	Callback callback{nullptr};
+	void* callbackParam{nullptr};
 };
 
 } // namespace IO
@@ -50,7 +50,31 @@ namespace IO
 	XX(nodes)                                                                                                          \
 	XX(devnodes)                                                                                                       \
 	XX(count)                                                                                                          \
-	XX(delay)
+	XX(delay)                                                                                                          \
+	XX(pools)                                                                                                          \
+	XX(priority)                                                                                                       \
+	XX(queue)                                                                                                          \
+	XX(highwater)                                                                                                      \
+	XX(controllers)                                                                                                    \
+	XX(deadline)                                                                                                       \
+	XX(timeout)                                                                                                        \
+	XX(adaptive)                                                                                                       \
+	XX(breaker)                                                                                                        \
+	XX(broadcast)                                                                                                      \
+	XX(points)                                                                                                         \
+	XX(table)                                                                                                          \
+	XX(type)                                                                                                           \
+	XX(scale)                                                                                                          \
+	XX(offset)                                                                                                         \
+	XX(gap)                                                                                                            \
+	XX(values)                                                                                                         \
+	XX(writebehind)                                                                                                    \
+	XX(transactions)                                                                                                   \
+	XX(batch)                                                                                                          \
+	XX(poll)                                                                                                           \
+	XX(missed)                                                                                                         \
+	XX(avg)                                                                                                            \
+	XX(max)
 
 #define XX(tag) DECLARE_FSTR(FS_##tag)
 IO_FLASHSTRING_MAP(XX)
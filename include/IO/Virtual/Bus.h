@@ -0,0 +1,150 @@
+/**
+ * Virtual/Bus.h
+ *
+ * Copyright 2022 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the IOControl Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#pragma once
+
+#include "../Serial.h"
+#include <Data/LinkedObjectList.h>
+
+namespace IO
+{
+namespace Virtual
+{
+/**
+ * @brief A simulated device attached to a virtual bus
+ */
+class Slave : public LinkedObjectTemplate<Slave>
+{
+public:
+	using List = LinkedObjectListTemplate<Slave>;
+
+	/**
+	 * @brief Construct a slave
+	 * @param segment Bus segment the slave is attached to
+	 * @param config Serial settings the slave expects; frames sent with other settings are not understood
+	 */
+	Slave(uint8_t segment, const IO::Serial::Config& config) : segment(segment), config(config)
+	{
+	}
+
+	Slave(uint8_t segment = 0) : Slave(segment, IO::Serial::Config{9600, UART_8N1})
+	{
+	}
+
+	/**
+	 * @brief Process a frame sent by the master
+	 * @param data Received frame
+	 * @param size Number of bytes received
+	 * @param response Buffer for reply, `Bus::MAX_RESPONSE` bytes
+	 * @retval size_t Size of reply, 0 if the slave doesn't respond
+	 */
+	virtual size_t receive(const uint8_t* data, size_t size, uint8_t* response) = 0;
+
+	uint8_t getSegment() const
+	{
+		return segment;
+	}
+
+	const IO::Serial::Config& getConfig() const
+	{
+		return config;
+	}
+
+private:
+	uint8_t segment;
+	IO::Serial::Config config;
+};
+
+/**
+ * @brief Simulated RS485 bus connecting a virtual serial port to a set of slaves
+ *
+ * Slaves are grouped into segments, which correspond to the transceivers selected by
+ * the controller's direction callback. A frame is only seen by slaves on the active segment
+ * with matching serial settings.
+ */
+class Bus
+{
+public:
+	static constexpr size_t MAX_RESPONSE{256};
+
+	struct Stats {
+		uint32_t frames;	 ///< Frames sent by the master
+		uint32_t responses;	 ///< Frames sent by slaves
+		uint32_t unanswered; ///< Frames to which no slave responded
+		uint32_t collisions; ///< Frames to which more than one slave responded
+	};
+
+	/**
+	 * @brief Attach a slave to the bus
+	 * @note Slaves are owned by the application
+	 */
+	void attach(Slave& slave)
+	{
+		slaves.add(&slave);
+	}
+
+	void detach(Slave& slave)
+	{
+		slaves.remove(&slave);
+	}
+
+	/**
+	 * @brief Set the time a slave takes between receiving a request and starting its response
+	 * @param us Delay in microseconds
+	 */
+	void setTurnaround(uint32_t us)
+	{
+		turnaround = us;
+	}
+
+	uint32_t getTurnaround() const
+	{
+		return turnaround;
+	}
+
+	/**
+	 * @brief Deliver a frame to all slaves on a segment
+	 * @param segment Active segment
+	 * @param config Serial settings used to send the frame
+	 * @param data Frame content
+	 * @param size Size of frame
+	 * @param response Buffer for reply, MAX_RESPONSE bytes
+	 * @retval size_t Size of reply, 0 if there is none
+	 */
+	size_t transmit(uint8_t segment, const IO::Serial::Config& config, const uint8_t* data, size_t size,
+					uint8_t* response);
+
+	const Stats& getStats() const
+	{
+		return stats;
+	}
+
+	void resetStats()
+	{
+		stats = Stats{};
+	}
+
+private:
+	Slave::List slaves;
+	uint32_t turnaround{0};
+	Stats stats{};
+};
+
+} // namespace Virtual
+} // namespace IO
@@ -0,0 +1,121 @@
+/**
+ * Virtual/Serial.h
+ *
+ * Copyright 2022 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the IOControl Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#pragma once
+
+#include "Bus.h"
+#include "../Clock.h"
+
+namespace IO
+{
+namespace Virtual
+{
+/**
+ * @brief Serial transport connected to a virtual bus instead of a UART
+ *
+ * Transmit and receive events are raised after the time the transfer would take on a real line,
+ * based on the configured baud rate and format plus the bus turnaround delay.
+ * Events are raised from timer callbacks rather than interrupts.
+ *
+ * The active segment is not visible to the serial port, so must be set via setSegment(),
+ * typically from the controller's direction callback.
+ *
+ * Break conditions are not modelled.
+ */
+class Serial : public IO::Serial
+{
+public:
+	static constexpr size_t BUFFER_SIZE{1024};
+
+	Serial(Bus& bus) : bus(bus)
+	{
+	}
+
+	~Serial()
+	{
+		close();
+	}
+
+	ErrorCode open(uint8_t uart_nr) override;
+	void close() override;
+
+	bool resizeBuffers(size_t rxSize, size_t txSize) override
+	{
+		return rxSize <= BUFFER_SIZE && txSize <= BUFFER_SIZE;
+	}
+
+	void setBreak(bool) override
+	{
+	}
+
+	size_t available() override
+	{
+		return rxLength - rxPos;
+	}
+
+	void setRxFullThreshold(uint8_t threshold) override
+	{
+		rxFullThreshold = threshold;
+	}
+
+	size_t read(void* buffer, size_t size) override;
+	size_t write(const void* data, size_t len) override;
+
+	void swap(uint8_t = 1) override
+	{
+	}
+
+	void clear(smg_uart_mode_t mode = UART_FULL) override;
+	void setConfig(const Config& cfg) override;
+
+	/**
+	 * @brief Select the bus segment used for subsequent transmissions
+	 */
+	void setSegment(uint8_t segment)
+	{
+		this->segment = segment;
+	}
+
+	uint8_t getSegment() const
+	{
+		return segment;
+	}
+
+private:
+	void transmitComplete();
+	void receiveComplete();
+
+	Bus& bus;
+	ClockTimer txTimer;
+	ClockTimer rxTimer;
+	uint32_t txStart{0};	 ///< Time (us) first byte of current frame was written
+	uint32_t rxStatus{0};	 ///< Status to report when response has arrived
+	uint16_t txLength{0};	 ///< Bytes written for current frame
+	uint16_t rxLength{0};	 ///< Bytes available to read
+	uint16_t rxPos{0};		 ///< Read position
+	uint16_t rxPending{0};	 ///< Response size still in transit
+	uint8_t rxFullThreshold{0};
+	uint8_t segment{0};
+	bool isOpen{false};
+	uint8_t txBuffer[BUFFER_SIZE];
+	uint8_t rxBuffer[BUFFER_SIZE];
+};
+
+} // namespace Virtual
+} // namespace IO
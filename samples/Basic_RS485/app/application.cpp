@@ -4,12 +4,25 @@
 #include <IO/Modbus/Debug.h>
 #include <IO/Modbus/Slave.h>
 #include <IO/Modbus/R421A/Request.h>
+#include <IO/Modbus/RegisterMap/Request.h>
 #include <IO/DMX512/Request.h>
 #include <IO/DeviceManager.h>
 
+#ifdef ARCH_HOST
+#include <IO/Virtual/Serial.h>
+#include <IO/Modbus/R421A/VirtualSlave.h>
+#endif
+
 namespace
 {
+#ifdef ARCH_HOST
+// Host builds have no RS485 hardware so use a simulated bus with a relay board to match device 'mb1'
+IO::Virtual::Bus bus;
+IO::Virtual::Serial serial0(bus);
+IO::Modbus::R421A::VirtualSlave relayBoard(1, 8);
+#else
 IO::Serial serial0;
+#endif
 IO::RS485::Controller rs485_0(serial0, 0);
 Timer testTimer;
 
@@ -118,6 +131,9 @@ void handleRS485Request(IO::RS485::Controller& controller)
  */
 void IRAM_ATTR setSerialDirection(uint8_t segment, IO::Direction direction)
 {
+#ifdef ARCH_HOST
+	serial0.setSegment(segment);
+#endif
 	digitalWrite(MBPIN_TX_EN, direction == IO::Direction::Outgoing);
 }
 
@@ -136,8 +152,15 @@ IO::ErrorCode devmgrInit()
 	// Use alternate serial pins and put default ones in safe state
 	serial0.swap();
 
+#ifdef ARCH_HOST
+	// Typical response latency for real hardware
+	bus.setTurnaround(2000);
+	bus.attach(relayBoard);
+#endif
+
 	// Setup modbus stack
 	rs485_0.registerDeviceClass(IO::Modbus::R421A::Device::factory);
+	rs485_0.registerDeviceClass(IO::Modbus::RegisterMap::Device::factory);
 	rs485_0.registerDeviceClass(IO::DMX512::Device::factory);
 	IO::devmgr.registerController(rs485_0);
 	rs485_0.onRequest(handleRS485Request);
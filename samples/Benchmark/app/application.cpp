@@ -0,0 +1,28 @@
+#include <SmingCore.h>
+#include <Benchmark.h>
+
+namespace
+{
+Timer startTimer;
+
+void run()
+{
+	Benchmark::crc16();
+	Benchmark::codec();
+	Benchmark::requests([]() { Serial.println(_F("Benchmarks complete.")); });
+}
+
+} // namespace
+
+void init()
+{
+	Serial.begin(COM_SPEED_SERIAL);
+	Serial.systemDebugOutput(true);
+
+#ifdef ARCH_HOST
+	setDigitalHooks(nullptr);
+#endif
+
+	// Allow serial output to settle
+	startTimer.initializeMs<1000>(run).startOnce();
+}
@@ -0,0 +1,189 @@
+#include <Benchmark.h>
+#include <IO/Modbus/ADU.h>
+
+/*
+ * Modbus ADU/PDU encode and decode
+ *
+ * Each function is measured with the smallest and largest payload it supports.
+ * Functions with a fixed layout are measured once.
+ *
+ * Byte-swapping is done in place, so repeated calls alternate the byte order of the frame
+ * but always perform the same work. Decoding starts from a copy of the received frame,
+ * as it would after reading from the serial port.
+ */
+namespace
+{
+using namespace IO::Modbus;
+
+constexpr unsigned ITERATIONS{1000};
+
+const Function functions[]{
+#define XX(tag, value) Function::tag,
+	MODBUS_FUNCTION_MAP(XX)
+#undef XX
+};
+
+volatile size_t result;
+
+/*
+ * Fill in any variable-length fields of request and response
+ */
+void setPayload(PDU& pdu, Function function, bool max)
+{
+	memset(&pdu.data, 0x5a, sizeof(pdu.data));
+	pdu.setFunction(function);
+
+	auto& data = pdu.data;
+	switch(function) {
+	case Function::ReadCoils:
+	case Function::ReadDiscreteInputs:
+		data.readCoils.response.setCount(max ? data.readCoils.response.MaxCoils : 1);
+		break;
+	case Function::ReadHoldingRegisters:
+	case Function::ReadInputRegisters:
+		data.readHoldingRegisters.response.setCount(max ? data.readHoldingRegisters.response.MaxRegisters : 1);
+		break;
+	case Function::GetComEventLog:
+		data.getComEventLog.response.setEventCount(max ? data.getComEventLog.response.MaxEvents : 0);
+		break;
+	case Function::ReportServerId:
+		data.reportServerId.response.setCount(max ? sizeof(data.reportServerId.response.data) : 0);
+		break;
+	default:
+		break;
+	}
+}
+
+/*
+ * Request and response share the PDU, so set up separately
+ */
+void setRequestPayload(PDU& pdu, Function function, bool max)
+{
+	setPayload(pdu, function, max);
+
+	auto& data = pdu.data;
+	switch(function) {
+	case Function::WriteMultipleCoils:
+		data.writeMultipleCoils.request.setCount(max ? data.writeMultipleCoils.request.MaxCoils : 1);
+		break;
+	case Function::WriteMultipleRegisters:
+		data.writeMultipleRegisters.request.setCount(max ? data.writeMultipleRegisters.request.MaxRegisters : 1);
+		break;
+	case Function::ReadWriteMultipleRegisters:
+		data.readWriteMultipleRegisters.request.setWriteCount(
+			max ? data.readWriteMultipleRegisters.request.MaxWriteRegisters : 1);
+		break;
+	default:
+		break;
+	}
+}
+
+void setResponsePayload(PDU& pdu, Function function, bool max)
+{
+	setPayload(pdu, function, max);
+
+	if(function == Function::ReadWriteMultipleRegisters) {
+		auto& rsp = pdu.data.readWriteMultipleRegisters.response;
+		rsp.setCount(max ? rsp.MaxReadRegisters : 1);
+	}
+}
+
+struct Result {
+	uint32_t swap;	 ///< ns per frame
+	uint32_t codec;	///< ns per frame
+	float cyclesPerByte; ///< For codec operation
+};
+
+uint32_t nsPerFrame(uint32_t elapsed)
+{
+	return uint64_t(elapsed) * 1000 / ITERATIONS;
+}
+
+float cyclesPerByte(uint32_t ns, size_t size)
+{
+	return float(ns) * system_get_cpu_freq() / 1000 / (size ?: 1);
+}
+
+size_t encode(ADU& adu, Function function, bool max, Result& res)
+{
+	adu.slaveAddress = 1;
+	setRequestPayload(adu.pdu, function, max);
+	res.swap = nsPerFrame(Benchmark::measure(ITERATIONS, [&]() { adu.pdu.swapRequestByteOrder(); }));
+
+	setRequestPayload(adu.pdu, function, max);
+	size_t size{0};
+	res.codec = nsPerFrame(Benchmark::measure(ITERATIONS, [&]() { result = size = adu.prepareRequest(); }));
+	res.cyclesPerByte = cyclesPerByte(res.codec, size);
+	return size;
+}
+
+size_t decode(ADU& adu, Function function, bool max, Result& res)
+{
+	adu.slaveAddress = 1;
+	setResponsePayload(adu.pdu, function, max);
+	res.swap = nsPerFrame(Benchmark::measure(ITERATIONS, [&]() { adu.pdu.swapResponseByteOrder(); }));
+
+	setResponsePayload(adu.pdu, function, max);
+	auto size = adu.prepareResponse();
+	uint8_t frame[ADU::MaxSize];
+	memcpy(frame, adu.buffer, size);
+	res.codec = nsPerFrame(Benchmark::measure(ITERATIONS, [&]() {
+		memcpy(adu.buffer, frame, size);
+		result = adu.parseResponse(size);
+	}));
+	res.cyclesPerByte = cyclesPerByte(res.codec, size);
+	return size;
+}
+
+void run(Function function, bool max, const char* label)
+{
+	ADU adu;
+	Result req;
+	Result rsp;
+	auto reqSize = encode(adu, function, max, req);
+	auto rspSize = decode(adu, function, max, rsp);
+	Serial.printf("  %-26s %-3s  %3u %6u %6u %6.1f  %3u %6u %6u %6.1f\r\n", toString(function).c_str(), label,
+				  reqSize, req.swap, req.codec, req.cyclesPerByte, rspSize, rsp.swap, rsp.codec,
+				  rsp.cyclesPerByte);
+}
+
+/*
+ * Payload size doesn't vary for some functions
+ */
+bool hasVariablePayload(Function function)
+{
+	PDU pdu;
+	setRequestPayload(pdu, function, false);
+	auto reqMin = pdu.getRequestSize();
+	setRequestPayload(pdu, function, true);
+	auto reqMax = pdu.getRequestSize();
+	setResponsePayload(pdu, function, false);
+	auto rspMin = pdu.getResponseSize();
+	setResponsePayload(pdu, function, true);
+	return reqMin != reqMax || rspMin != pdu.getResponseSize();
+}
+
+} // namespace
+
+namespace Benchmark
+{
+void codec()
+{
+	Serial.printf("ADU/PDU codec, %u iterations, %u MHz, times in ns per frame\r\n", ITERATIONS,
+				  system_get_cpu_freq());
+	Serial.println(_F("  Function                   size   req   swap encode  cyc/B  rsp   swap decode  cyc/B"));
+
+	for(auto function : functions) {
+		if(function == Function::None) {
+			continue;
+		}
+		if(hasVariablePayload(function)) {
+			run(function, false, "min");
+			run(function, true, "max");
+		} else {
+			run(function, true, "");
+		}
+	}
+}
+
+} // namespace Benchmark
@@ -0,0 +1,42 @@
+#include <Benchmark.h>
+#include <IO/Modbus/CRC16.h>
+
+namespace
+{
+constexpr size_t FRAME_SIZE{256};
+constexpr unsigned ITERATIONS{2000};
+
+using UpdateFunc = uint16_t (*)(uint16_t crc, const void* data, size_t count);
+
+volatile uint16_t result;
+
+void run(const char* name, UpdateFunc update, const uint8_t* frame)
+{
+	auto elapsed = Benchmark::measure(ITERATIONS, [&]() { result = update(0xFFFF, frame, FRAME_SIZE); });
+	auto rate = float(FRAME_SIZE) * ITERATIONS / (elapsed ?: 1);
+	Serial.printf("  %-8s %04x %8u us %8.2f bytes/us\r\n", name, result, elapsed, rate);
+}
+
+} // namespace
+
+namespace Benchmark
+{
+void crc16()
+{
+	using namespace IO::Modbus;
+
+	uint8_t frame[FRAME_SIZE];
+	for(unsigned i = 0; i < FRAME_SIZE; ++i) {
+		frame[i] = os_random();
+	}
+
+	Serial.printf("CRC16, %u x %u-byte frames\r\n", ITERATIONS, FRAME_SIZE);
+	run("bitwise", CRC16::updateBitwise, frame);
+	run("table", CRC16::updateTable, frame);
+#ifdef ARCH_HOST
+	run("slice4", CRC16::updateSlice4, frame);
+	run("slice8", CRC16::updateSlice8, frame);
+#endif
+}
+
+} // namespace Benchmark
@@ -0,0 +1,284 @@
+#include <Benchmark.h>
+#include <FlashString/Stream.hpp>
+#include <IO/DeviceManager.h>
+#include <IO/Virtual/Serial.h>
+#include <IO/Modbus/R421A/Request.h>
+#include <IO/Modbus/R421A/VirtualSlave.h>
+#include <IO/DMX512/Request.h>
+#include <IO/RFSwitch/Controller.h>
+#include <IO/RFSwitch/Request.h>
+#include <algorithm>
+#include <vector>
+
+#ifdef ENABLE_MALLOC_COUNT
+#include <malloc_count.h>
+#endif
+
+/*
+ * End-to-end request benchmarks
+ *
+ * Requests are issued either directly (createRequest + submit) or as JSON messages via
+ * DeviceManager::handleMessage(), with a fixed number outstanding at any time.
+ * Modbus requests run over a virtual bus at 1 Mbaud so the request path dominates.
+ */
+namespace
+{
+IMPORT_FSTR_LOCAL(DEVMGR_CONFIG, PROJECT_DIR "/config/devices.json")
+
+constexpr unsigned WINDOW{4}; ///< Number of requests outstanding
+constexpr uint8_t RF_PIN{5};
+
+struct Test {
+	const char* name;
+	const char* device;
+	bool message; ///< Use handleMessage() instead of submit()
+	unsigned count;
+};
+
+// DMX runs last as its requests leave slave updates queued behind them
+const Test tests[]{
+	{"modbus", "mb1", false, 500},	{"modbus", "mb1", true, 500},	 {"rfswitch", "rf1", false, 10},
+	{"rfswitch", "rf1", true, 10},	{"dmx512", "dmx1", false, 5000}, {"dmx512", "dmx1", true, 5000},
+};
+constexpr unsigned TEST_COUNT{ARRAY_SIZE(tests)};
+
+IO::Virtual::Bus bus;
+IO::Virtual::Serial serial(bus);
+IO::RS485::Controller rs485(serial, 0);
+IO::RFSwitch::Controller rfswitch(0, RF_PIN, false);
+IO::Modbus::R421A::VirtualSlave relays(1, 8, 0, IO::Serial::Config{1000000, UART_8N1});
+
+class Runner
+{
+public:
+	/**
+	 * @brief Run all tests once start-up queries have completed
+	 */
+	void begin(Benchmark::Callback callback)
+	{
+		this->callback = callback;
+		doc.clear();
+		results = doc.createNestedArray("requests");
+		testIndex = 0;
+		timer.initializeMs<500>([](void* param) { static_cast<Runner*>(param)->start(); }, this);
+		timer.startOnce();
+	}
+
+private:
+	void start();
+	void fill();
+	void submit();
+	void requestComplete(const IO::Request& request, uint32_t startTime);
+	void finish();
+
+	void queueFill()
+	{
+		if(!fillQueued) {
+			fillQueued = true;
+			System.queueCallback([](void* param) { static_cast<Runner*>(param)->fill(); }, this);
+		}
+	}
+
+	const Test& test() const
+	{
+		return tests[testIndex];
+	}
+
+	Benchmark::Callback callback;
+	SimpleTimer timer;
+	DynamicJsonDocument doc{4096};
+	JsonArray results;
+	std::vector<uint32_t> latencies;
+	unsigned testIndex{0};
+	unsigned submitted{0};
+	unsigned completed{0};
+	unsigned errors{0};
+	uint32_t startTime{0};
+	size_t heapStart{0};
+	size_t allocStart{0};
+	bool fillQueued{false};
+};
+
+Runner runner;
+
+void Runner::start()
+{
+	if(testIndex >= TEST_COUNT) {
+		Serial.println(_F("Requests JSON:"));
+		Json::serialize(doc, Serial);
+		Serial.println();
+		callback();
+		return;
+	}
+
+	// Reserve storage before taking heap measurements
+	latencies.clear();
+	latencies.reserve(test().count);
+	submitted = completed = errors = 0;
+#ifdef ENABLE_MALLOC_COUNT
+	MallocCount::resetPeak();
+	heapStart = MallocCount::getCurrent();
+	allocStart = MallocCount::getAllocCount();
+#endif
+	startTime = micros();
+	fill();
+}
+
+void Runner::fill()
+{
+	fillQueued = false;
+	while(submitted < test().count && submitted - completed < WINDOW) {
+		submit();
+	}
+}
+
+void Runner::submit()
+{
+	auto& t = test();
+	auto index = submitted++;
+	uint32_t requestStart = micros();
+	IO::Request::Callback requestCallback = [requestStart](const IO::Request& request) {
+		runner.requestComplete(request, requestStart);
+	};
+
+	if(t.message) {
+		StaticJsonDocument<256> msg;
+		auto json = msg.to<JsonObject>();
+		json["device"] = t.device;
+		switch(*t.name) {
+		case 'm':
+			json["command"] = "toggle";
+			json["node"] = 1 + index % 8;
+			break;
+		case 'd':
+			json["command"] = "adjust";
+			json["node"] = index % 16;
+			json["value"] = 1;
+			break;
+		default:
+			json["code"] = "a5a5a5";
+		}
+		auto err = IO::devmgr.handleMessage(json, requestCallback);
+		if(err) {
+			++errors;
+			++completed;
+			queueFill();
+		}
+		return;
+	}
+
+	IO::Request* req;
+	auto err = IO::devmgr.createRequest(t.device, req);
+	if(err) {
+		++errors;
+		++completed;
+		queueFill();
+		return;
+	}
+
+	switch(req->device.type()) {
+	case IO::DeviceType::Modbus:
+		req->nodeToggle(IO::DevNode{IO::DevNode::ID(1 + index % 8)});
+		break;
+	case IO::DeviceType::DMX512:
+		req->nodeAdjust(IO::DevNode{IO::DevNode::ID(index % 16)}, 1);
+		break;
+	default:
+		static_cast<IO::RFSwitch::Request*>(req)->send(0xa5a5a5);
+	}
+	req->onComplete(requestCallback);
+	req->submit();
+}
+
+void Runner::requestComplete(const IO::Request& request, uint32_t requestStart)
+{
+	if(request.isPending()) {
+		return;
+	}
+
+	latencies.push_back(micros() - requestStart);
+	if(request.error()) {
+		++errors;
+	}
+	++completed;
+	if(completed < test().count) {
+		queueFill();
+		return;
+	}
+
+	System.queueCallback([](void* param) { static_cast<Runner*>(param)->finish(); }, this);
+}
+
+void Runner::finish()
+{
+	auto elapsed = micros() - startTime;
+	auto& t = test();
+
+	auto percentile = [&](unsigned percent) -> uint32_t {
+		if(latencies.empty()) {
+			return 0;
+		}
+		auto n = std::min(latencies.size() * percent / 100, latencies.size() - 1);
+		std::nth_element(latencies.begin(), latencies.begin() + n, latencies.end());
+		return latencies[n];
+	};
+
+	auto res = results.createNestedObject();
+	res["path"] = t.name;
+	res["api"] = t.message ? "message" : "submit";
+	res["count"] = t.count;
+	res["errors"] = errors;
+	res["elapsed"] = elapsed;
+	float rate = 1e6f * t.count / (elapsed ?: 1);
+	res["rate"] = rate;
+	auto p50 = percentile(50);
+	auto p99 = percentile(99);
+	res["p50"] = p50;
+	res["p99"] = p99;
+#ifdef ENABLE_MALLOC_COUNT
+	float allocs = float(MallocCount::getAllocCount() - allocStart) / t.count;
+	res["allocs"] = allocs;
+	res["peak"] = MallocCount::getPeak() - heapStart;
+#endif
+
+	Serial.printf("  %-8s %-7s %5u req %3u err %10.1f req/s  p50 %6u us  p99 %6u us\r\n", t.name,
+				  t.message ? "message" : "submit", t.count, errors, rate, p50, p99);
+
+	++testIndex;
+	start();
+}
+
+} // namespace
+
+namespace Benchmark
+{
+void requests(Callback callback)
+{
+	Serial.printf("Requests, %u outstanding\r\n", WINDOW);
+
+	IO::RS485::Controller::registerDeviceClass(IO::Modbus::R421A::Device::factory);
+	IO::RS485::Controller::registerDeviceClass(IO::DMX512::Device::factory);
+	IO::RFSwitch::Controller::registerDeviceClass(IO::RFSwitch::Device::factory);
+	IO::devmgr.registerController(rs485);
+	IO::devmgr.registerController(rfswitch);
+	serial.open(0);
+	bus.attach(relays);
+
+	DynamicJsonDocument config(2048);
+	FSTR::Stream str(DEVMGR_CONFIG);
+	if(!Json::deserialize(config, str)) {
+		Serial.println(_F("Device config load failed"));
+		callback();
+		return;
+	}
+	auto err = IO::devmgr.begin(config.as<JsonObjectConst>());
+	if(err) {
+		Serial.printf("Device manager failed, %s\r\n", IO::Error::toString(err).c_str());
+		callback();
+		return;
+	}
+
+	runner.begin(callback);
+}
+
+} // namespace Benchmark
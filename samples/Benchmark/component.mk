@@ -0,0 +1,10 @@
+ARDUINO_LIBRARIES := \
+    IOControl \
+    ArduinoJson6
+
+DISABLE_NETWORK := 1
+
+# Track heap usage for request benchmarks
+ifeq ($(SMING_ARCH),Host)
+ENABLE_MALLOC_COUNT := 1
+endif
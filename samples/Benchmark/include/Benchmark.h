@@ -0,0 +1,31 @@
+#pragma once
+
+#include <SmingCore.h>
+
+namespace Benchmark
+{
+/**
+ * @brief Time a number of calls to a function
+ * @retval uint32_t Elapsed time in microseconds
+ */
+template <typename Func> uint32_t measure(unsigned iterations, Func func)
+{
+	auto start = micros();
+	while(iterations--) {
+		func();
+	}
+	return micros() - start;
+}
+
+using Callback = Delegate<void()>;
+
+void crc16();
+void codec();
+
+/**
+ * @brief Measure end-to-end request throughput and latency against simulated devices
+ * @param callback Invoked when all tests have completed
+ */
+void requests(Callback callback);
+
+} // namespace Benchmark
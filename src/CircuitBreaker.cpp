@@ -0,0 +1,75 @@
+/**
+ * CircuitBreaker.cpp
+ *
+ * Copyright 2022 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the IOControl Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#include <IO/CircuitBreaker.h>
+#include <debug_progmem.h>
+#include <algorithm>
+
+namespace IO
+{
+bool CircuitBreaker::canExecute(uint32_t now)
+{
+	switch(state) {
+	case State::closed:
+	case State::halfOpen:
+		return true;
+
+	case State::open:
+		if((now - openTime) < backoff) {
+			return false;
+		}
+		state = State::halfOpen;
+		return true;
+	}
+
+	return false;
+}
+
+void CircuitBreaker::recordResult(ErrorCode err, uint32_t now)
+{
+	if(threshold == 0) {
+		return;
+	}
+
+	if(!isFault(err)) {
+		reset();
+		return;
+	}
+
+	switch(state) {
+	case State::closed:
+		if(++failCount < threshold) {
+			return;
+		}
+		break;
+
+	case State::halfOpen:
+		backoff = std::min(backoff * 2, CIRCUIT_BREAKER_BACKOFF_MAX);
+		break;
+
+	case State::open:
+		return;
+	}
+
+	state = State::open;
+	openTime = now;
+	debug_w("[IO] Circuit breaker open, retry in %u ms", backoff);
+}
+
+} // namespace IO
@@ -0,0 +1,145 @@
+/**
+ * Clock.cpp
+ *
+ * Copyright 2022 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the IOControl Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#include <IO/Clock.h>
+#include <algorithm>
+
+#if IOCONTROL_VIRTUAL_CLOCK
+
+namespace IO
+{
+namespace
+{
+constexpr uint32_t DEFAULT_SEED{0x12345678};
+
+uint64_t currentTime;
+uint32_t randomState{DEFAULT_SEED};
+LinkedObjectListTemplate<ClockTimer> activeTimers;
+} // namespace
+
+namespace Clock
+{
+uint32_t micros()
+{
+	return currentTime;
+}
+
+uint32_t millis()
+{
+	return currentTime / 1000;
+}
+
+void delayMicroseconds(uint32_t us)
+{
+	currentTime += us;
+}
+
+uint64_t now()
+{
+	return currentTime;
+}
+
+/*
+ * xorshift32
+ */
+uint32_t random()
+{
+	auto x = randomState;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	randomState = x;
+	return x;
+}
+
+void seed(uint32_t value)
+{
+	randomState = value ?: DEFAULT_SEED;
+}
+
+/*
+ * Timers due at the same time fire in the order they were started.
+ */
+bool advance(uint32_t limit)
+{
+	ClockTimer* next{nullptr};
+	for(auto& timer : activeTimers) {
+		if(next == nullptr || timer.due < next->due) {
+			next = &timer;
+		}
+	}
+
+	if(next == nullptr) {
+		return false;
+	}
+
+	if(next->due > currentTime + limit) {
+		currentTime += limit;
+		return true;
+	}
+
+	currentTime = std::max(currentTime, next->due);
+	if(next->repeating) {
+		// Avoid stalling the clock with a zero interval
+		next->due += std::max(next->interval, uint64_t(1));
+	} else {
+		next->stop();
+	}
+
+	if(next->callback != nullptr) {
+		next->callback(next->param);
+	}
+
+	return true;
+}
+
+} // namespace Clock
+
+bool ClockTimer::setIntervalUs(uint64_t us)
+{
+	interval = us;
+	if(started) {
+		start(repeating);
+	}
+	return true;
+}
+
+bool ClockTimer::start(bool repeating)
+{
+	if(started) {
+		activeTimers.remove(this);
+	}
+	this->repeating = repeating;
+	due = currentTime + interval;
+	started = true;
+	activeTimers.add(this);
+	return true;
+}
+
+void ClockTimer::stop()
+{
+	if(started) {
+		activeTimers.remove(this);
+		started = false;
+	}
+}
+
+} // namespace IO
+
+#endif
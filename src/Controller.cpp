@@ -22,6 +22,7 @@
 #include <IO/DeviceManager.h>
 #include <IO/Strings.h>
 #include <IO/Debug.h>
+#include <IO/Clock.h>
 
 // Controller attempts device restart on error at this interval
 #define DEVICECHECK_INTERVAL 10000
@@ -30,6 +31,18 @@ namespace IO
 {
 DeviceFactoryList Controller::deviceClasses;
 
+DEFINE_FSTR_LOCAL(FS_rejected, "rejected")
+
+Controller::~Controller()
+{
+	for(auto& queue : queues) {
+		Request* req;
+		while((req = queue.pop())) {
+			delete req;
+		}
+	}
+}
+
 const Device::Factory* Controller::findDeviceClass(const String& className)
 {
 	for(auto& factory : deviceClasses) {
@@ -81,20 +94,34 @@ ErrorCode Controller::createDevice(const char* id, JsonObjectConst config, Devic
 		return err;
 	}
 
-	devices.add(device);
+	addDevice(device);
 	debug_d("Device %s created, class %s", device->caption().c_str(), cls.c_str());
 
 	return err;
 }
 
+void Controller::addDevice(Device* device)
+{
+	devices.add(device);
+	devmgr.devicesChanged();
+}
+
 void Controller::freeDevices()
 {
 	devices.clear();
+	devmgr.devicesChanged();
 }
 
-Device* Controller::findDevice(const String& id)
+Device* Controller::findDevice(const char* id, size_t length)
 {
-	return std::find(devices.begin(), devices.end(), id);
+	for(auto& device : devices) {
+		auto& devid = device.getId();
+		if(devid.length() == length && memcmp(devid.c_str(), id, length) == 0) {
+			return &device;
+		}
+	}
+
+	return nullptr;
 }
 
 /*
@@ -106,7 +133,7 @@ void Controller::startTimer()
 	PRINT_HEAP();
 
 	if(!deviceCheckTimer) {
-		deviceCheckTimer.reset(new SimpleTimer);
+		deviceCheckTimer.reset(new ClockTimer);
 		if(!deviceCheckTimer) {
 			return;
 		}
@@ -156,11 +183,79 @@ void Controller::startDevices()
 void Controller::stopDevices()
 {
 	stopTimer();
+	pollTimer.reset();
 	for(auto& dev : devices) {
 		dev.stop();
 	}
 }
 
+/*
+ * Each device's first poll falls at a random point within its interval,
+ * so devices polled at the same rate don't all hit the bus together.
+ */
+void Controller::startPolling()
+{
+	uint32_t now = Clock::millis();
+	for(auto& dev : devices) {
+		if(dev.pollInterval != 0) {
+			dev.nextPoll = now + Clock::random() % dev.pollInterval;
+		}
+	}
+	schedulePoll();
+}
+
+/*
+ * Arm the timer for the next device due to be polled
+ */
+void Controller::schedulePoll()
+{
+	uint32_t now = Clock::millis();
+	int32_t wait{-1};
+	for(auto& dev : devices) {
+		if(dev.pollInterval == 0) {
+			continue;
+		}
+		int32_t t = std::max(int32_t(dev.nextPoll - now), int32_t(1));
+		if(wait < 0 || t < wait) {
+			wait = t;
+		}
+	}
+
+	if(wait < 0) {
+		pollTimer.reset();
+		return;
+	}
+
+	if(!pollTimer) {
+		pollTimer.reset(new ClockTimer);
+		if(!pollTimer) {
+			return;
+		}
+		pollTimer->setCallback([](void* arg) { static_cast<Controller*>(arg)->pollDevices(); }, this);
+	}
+
+	pollTimer->setIntervalMs(wait);
+	pollTimer->startOnce();
+}
+
+void Controller::pollDevices()
+{
+	uint32_t now = Clock::millis();
+	for(auto& dev : devices) {
+		if(dev.pollInterval == 0 || int32_t(now - dev.nextPoll) < 0) {
+			continue;
+		}
+		dev.poll(dev.nextPoll);
+		dev.nextPoll += dev.pollInterval;
+		if(int32_t(now - dev.nextPoll) >= 0) {
+			// Fallen behind, don't try to catch up
+			dev.nextPoll = now + dev.pollInterval;
+		}
+	}
+
+	schedulePoll();
+}
+
 /*
  * An error occurred on a device. Schedule a restart operation.
  */
@@ -169,49 +264,109 @@ void Controller::deviceError(Device& device)
 	startTimer();
 }
 
-void Controller::submit(Request* request)
+bool Controller::isIdle() const
 {
-	bool idle = queue.isEmpty();
+	if(activeRequest != nullptr || !held.isEmpty()) {
+		return false;
+	}
 
+	for(auto& queue : queues) {
+		if(!queue.isEmpty()) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void Controller::getQueueStats(JsonObject json) const
+{
+	for(unsigned i = 0; i < PRIORITY_COUNT; ++i) {
+		auto& stats = queueStats[i];
+		JsonObject obj = json.createNestedObject(toString(Priority(i)));
+		obj[FS_count] = stats.count;
+		obj[FS_avg] = stats.averageWait();
+		obj[FS_max] = stats.maxWait;
+		obj[FS_rejected] = stats.rejected;
+	}
+}
+
+void Controller::submit(Request* request)
+{
 	/*
 	 * Can re-submit a request instead of completing it to retry or progress
 	 * a multi-IO call without having to create a new request object.
 	 * So we only need to be in the queue once.
 	 * Callback is invoked only at initial execution.
 	 */
-	if(!idle && queue.head() == request) {
+	if(request == activeRequest) {
 		debug_d("Re-submitting request %s", request->caption().c_str());
 		// Execute directly, don't invoke callback
-		request->handleEvent(Event::Execute);
+		startExecution(*request);
+		return;
+	}
+
+	if(!request->device.breaker.canSubmit(Clock::millis())) {
+		debug_w("[IO] Device offline, rejecting request %s", request->caption().c_str());
+		request->complete(Error::offline);
 		return;
 	}
 
-	debug_d("Queueing request %s", request->caption().c_str());
-	queue.add(request);
+	if(!checkQueueLimit(*request)) {
+		request->complete(Error::queue_full);
+		return;
+	}
 
-	if(idle) {
-		executeNext();
+	request->queueTime = Clock::millis();
+	request->timing.submit = Clock::micros();
+	queueCountChanged(*request, 1);
+
+	if(request->device.deferRequest(*request)) {
+		return;
+	}
+
+	if(coalesce(request)) {
+		return;
 	}
+
+	debug_d("Queueing request %s (%s)", request->caption().c_str(), toString(request->getPriority()).c_str());
+	queues[unsigned(request->getPriority())].add(request);
+
+	executeNext();
 }
 
 void Controller::handleEvent(Request* request, Event event)
 {
 	switch(event) {
-	case Event::Execute:
+	case Event::Execute: {
 		devmgr.invokeCallback(*request);
+		// Merged requests execute along with this one
+		Request* next;
+		for(auto req = request->merged.head(); req != nullptr; req = next) {
+			next = req->getNext();
+			if(req->timing.execute == 0) {
+				req->timing.execute = Clock::micros();
+				devmgr.invokeCallback(*req);
+			}
+		}
 		break;
+	}
 
 	case Event::RequestComplete:
 		devmgr.invokeCallback(*request);
+		completeMerged(*request);
 
 		// Requests don't need to be queued (e.g. DMX512 handles them immediately as it only updates internal state)
-		if(queue.head() == request) {
-			queue.remove(request);
+		if(request == activeRequest) {
+			auto now = Clock::micros();
+			latencyStats.add(*request, now);
+			request->device.latencyStats.add(*request, now);
+			activeRequest = nullptr;
+			delete request;
+			executeNext();
 		} else {
 			delete request;
 		}
-
-		executeNext();
 		break;
 
 	case Event::ReceiveComplete:
@@ -224,13 +379,370 @@ void Controller::handleEvent(Request* request, Event event)
 	}
 }
 
+/*
+ * Fetch the next request to execute.
+ *
+ * Each queue is FIFO so only the heads need to be considered.
+ * A request is promoted one priority level for every `agingInterval` it has been waiting,
+ * so background requests get a look-in even when the bus is busy.
+ * On a tie the higher base priority wins.
+ */
+Request* Controller::dequeue()
+{
+	uint32_t now = Clock::millis();
+	Request::List* queue{nullptr};
+	unsigned queueLevel{0};
+	for(unsigned i = PRIORITY_COUNT; i-- > 0;) {
+		auto req = queues[i].head();
+		if(req == nullptr) {
+			continue;
+		}
+		unsigned level = i + (now - req->queueTime) / agingInterval;
+		if(queue == nullptr || level > queueLevel) {
+			queue = &queues[i];
+			queueLevel = level;
+		}
+	}
+
+	if(queue == nullptr) {
+		return nullptr;
+	}
+
+	auto req = queue->head();
+	if(batchLimit != 0 && bypassCount < batchLimit && !isSameLink(*req)) {
+		auto next = findBatchable(*queue);
+		if(next != nullptr) {
+			debug_d("[IO] Batching %s ahead of %s", next->caption().c_str(), req->caption().c_str());
+			req = next;
+			++bypassCount;
+		}
+	}
+	if(req == queue->head()) {
+		bypassCount = 0;
+	}
+	queue->remove(req);
+	queueCountChanged(*req, -int(1 + req->merged.count()));
+	uint32_t wait = now - req->queueTime;
+	auto& stats = queueStats[unsigned(req->getPriority())];
+	++stats.count;
+	stats.totalWait += wait;
+	stats.maxWait = std::max(stats.maxWait, wait);
+	return req;
+}
+
+/*
+ * Find the first request in a queue which can execute without reconfiguring the bus,
+ * and doesn't overtake an earlier request for the same device.
+ */
+Request* Controller::findBatchable(Request::List& queue)
+{
+	for(auto& req : queue) {
+		if(!isSameLink(req)) {
+			continue;
+		}
+		bool overtakes{false};
+		for(auto& earlier : queue) {
+			if(&earlier == &req) {
+				break;
+			}
+			if(&earlier.device == &req.device) {
+				overtakes = true;
+				break;
+			}
+		}
+		if(!overtakes) {
+			return &req;
+		}
+	}
+	return nullptr;
+}
+
+/*
+ * Look for a queued request which a new request can be merged with.
+ *
+ * Only the most recent request queued for the same device at the same priority is considered,
+ * so the outcome is the same as executing both in order. Ordering between priority levels isn't fixed,
+ * so requests are left alone if the device has requests pending at other levels.
+ */
+bool Controller::coalesce(Request* request)
+{
+	Request* last{nullptr};
+	for(unsigned i = 0; i < PRIORITY_COUNT; ++i) {
+		for(auto& req : queues[i]) {
+			if(&req.device != &request->device) {
+				continue;
+			}
+			if(Priority(i) != request->getPriority()) {
+				return false;
+			}
+			last = &req;
+		}
+	}
+
+	if(last == nullptr) {
+		return false;
+	}
+
+	auto merge = request->checkMerge(*last);
+	if(merge == Request::Merge::none) {
+		return false;
+	}
+
+	/*
+	 * Only the surviving request is checked against its deadline, and if it expires the other completes with it.
+	 * Neither may then be held up beyond its own deadline, nor fail before it.
+	 */
+	if(request->expiresBefore(*last) || last->expiresBefore(*request)) {
+		return false;
+	}
+
+	switch(merge) {
+	case Request::Merge::duplicate:
+		debug_d("Request %s duplicates %s", request->caption().c_str(), last->caption().c_str());
+		last->merge(request);
+		++mergeCount;
+		return true;
+
+	case Request::Merge::supersede:
+		debug_d("Request %s supersedes %s", request->caption().c_str(), last->caption().c_str());
+		queues[unsigned(last->getPriority())].remove(last);
+		request->merge(last);
+		++mergeCount;
+		return false;
+
+	case Request::Merge::none:
+	default:
+		return false;
+	}
+}
+
+/*
+ * Requests merged with this one take its result
+ */
+void Controller::completeMerged(Request& request)
+{
+	Request* req;
+	while((req = request.merged.pop())) {
+		req->copyResult(request);
+		req->errorCode = request.errorCode;
+		debug_i("Request %p (%s) complete - %s", req, req->id().c_str(), Error::toString(req->errorCode).c_str());
+		if(req->callback) {
+			req->callback(*req);
+		}
+		devmgr.invokeCallback(*req);
+		delete req;
+	}
+}
+
+bool Controller::checkQueueLimit(Request& request)
+{
+	auto& device = request.device;
+	if((queueLimit == 0 || queueCount < queueLimit) &&
+	   (device.queueLimit == 0 || device.queueCount < device.queueLimit)) {
+		return true;
+	}
+
+	debug_w("[IO] Queue full, rejecting request %s", request.caption().c_str());
+	++queueStats[unsigned(request.getPriority())].rejected;
+	return false;
+}
+
+/*
+ * Track the number of requests waiting and notify device manager when congestion starts or ends.
+ * Requests merged with others count as waiting since they still occupy memory.
+ */
+void Controller::queueCountChanged(Request& request, int change)
+{
+	queueCount += change;
+	request.device.queueCount += change;
+
+	if(queueHighWater == 0) {
+		return;
+	}
+
+	if(!congested && queueCount >= queueHighWater) {
+		congested = true;
+	} else if(congested && queueCount <= queueHighWater / 2) {
+		congested = false;
+	} else {
+		return;
+	}
+
+	debug_i("[IO] %s queue %s (%u)", id.c_str(), congested ? "congested" : "drained", queueCount);
+	devmgr.invokeQueueCallback(*this);
+}
+
+bool Controller::cancel(Request* request)
+{
+	if(request == activeRequest) {
+		return false;
+	}
+
+	for(auto& queue : queues) {
+		if(queue.remove(request)) {
+			queueCountChanged(*request, -int(1 + request->merged.count()));
+			debug_i("[IO] Request %s cancelled", request->caption().c_str());
+			request->complete(Error::cancelled);
+			return true;
+		}
+	}
+
+	// Merged requests can be detached, the request they're merged with still executes
+	for(auto& queue : queues) {
+		for(auto& req : queue) {
+			if(req.unmerge(request)) {
+				queueCountChanged(*request, -1);
+				request->complete(Error::cancelled);
+				return true;
+			}
+		}
+	}
+
+	// Held requests don't count towards the queue, only those merged with them
+	if(held.remove(request)) {
+		queueCountChanged(*request, -int(request->merged.count()));
+		debug_i("[IO] Request %s cancelled", request->caption().c_str());
+		request->complete(Error::cancelled);
+		return true;
+	}
+
+	for(auto& req : held) {
+		if(req.unmerge(request)) {
+			queueCountChanged(*request, -1);
+			request->complete(Error::cancelled);
+			return true;
+		}
+	}
+
+	if(activeRequest != nullptr && activeRequest->unmerge(request)) {
+		request->complete(Error::cancelled);
+		return true;
+	}
+
+	return false;
+}
+
+void Controller::hold(Request& holder, Request& request)
+{
+	if(!held.contains(holder)) {
+		holder.queueTime = Clock::millis();
+		holder.timing.submit = Clock::micros();
+		held.add(&holder);
+	}
+	holder.merge(&request);
+}
+
+void Controller::release(Request& holder)
+{
+	if(!held.remove(&holder)) {
+		return;
+	}
+
+	debug_d("Queueing held request %s (%s)", holder.caption().c_str(), toString(holder.getPriority()).c_str());
+	queueCountChanged(holder, 1);
+	queues[unsigned(holder.getPriority())].add(&holder);
+	executeNext();
+}
+
+Request* Controller::findRequest(const String& requestId)
+{
+	auto find = [&](Request& req) -> Request* {
+		for(auto& r : req.merged) {
+			if(r.id() == requestId) {
+				return &r;
+			}
+		}
+		return nullptr;
+	};
+
+	for(auto& queue : queues) {
+		for(auto& req : queue) {
+			if(req.id() == requestId) {
+				return &req;
+			}
+			auto r = find(req);
+			if(r != nullptr) {
+				return r;
+			}
+		}
+	}
+
+	for(auto& req : held) {
+		auto r = find(req);
+		if(r != nullptr) {
+			return r;
+		}
+	}
+
+	return activeRequest ? find(*activeRequest) : nullptr;
+}
+
+unsigned Controller::cancelRequests(const String& requestId)
+{
+	unsigned count{0};
+	Request* req;
+	while((req = findRequest(requestId)) != nullptr && cancel(req)) {
+		++count;
+	}
+	return count;
+}
+
 void Controller::executeNext()
 {
-	auto req = queue.head();
-	if(req != nullptr) {
-		debug_i("Executing request %p, %s: %s", req, req->id().c_str(), toString(req->getCommand()).c_str());
-		req->handleEvent(Event::Execute);
+	if(activeRequest != nullptr) {
+		return;
 	}
+
+	// Drop any requests which have passed their deadline or whose device is offline
+	Request* req;
+	while((req = dequeue()) != nullptr) {
+		uint32_t now = Clock::millis();
+		ErrorCode err;
+		if(req->isExpired(now)) {
+			debug_w("[IO] Request %s expired", req->caption().c_str());
+			err = Error::timeout;
+		} else if(!req->device.breaker.canExecute(now)) {
+			debug_w("[IO] Device offline, dropping request %s", req->caption().c_str());
+			err = Error::offline;
+		} else {
+			break;
+		}
+		req->complete(err);
+		// Callback may have submitted a request which is now executing
+		if(activeRequest != nullptr) {
+			return;
+		}
+	}
+
+	if(req == nullptr) {
+		return;
+	}
+
+	debug_i("Executing request %p, %s: %s", req, req->id().c_str(), toString(req->getCommand()).c_str());
+	activeRequest = req;
+
+	// Requests merged by a device (see `hold()`) keep their own deadlines
+	uint32_t now = Clock::millis();
+	Request::List expired;
+	Request* next;
+	for(auto merged = req->merged.head(); merged != nullptr; merged = next) {
+		next = merged->getNext();
+		if(merged->isExpired(now)) {
+			debug_w("[IO] Request %s expired", merged->caption().c_str());
+			req->unmerge(merged);
+			expired.add(merged);
+		}
+	}
+	while((next = expired.pop()) != nullptr) {
+		next->complete(Error::timeout);
+	}
+
+	startExecution(*req);
+}
+
+void Controller::startExecution(Request& request)
+{
+	request.handleEvent(Event::Execute);
 }
 
 } // namespace IO
@@ -29,7 +29,7 @@ namespace IO
 namespace DMX512
 {
 const Device::Factory Device::factory;
-SimpleTimer Device::timer;
+ClockTimer Device::timer;
 bool Device::dataChanged{false};
 bool Device::updating{false};
 
@@ -77,20 +77,9 @@ void Device::updateSlaves()
 	debug_i("[DMX512] updateSlaves()");
 
 	auto& serial = getController().getSerial();
+	getController().setConfig(getSerialConfig());
 
-	Serial::Config cfg{
-		.baudrate = DMX_BAUDRATE,
-		.format = DMX_SERIAL_FORMAT,
-	};
-	serial.setConfig(cfg);
-
-	const uint16_t maxAddr = 512;
-
-	// data + padding - note address #0 isn't used and is always set to 0 for lighting applications
-	unsigned dataSize = maxAddr + 1 + 2;
-	uint8_t data[dataSize];
-	memset(data, 0, dataSize);
-	data[0] = 0x00; // Lighting start code
+	// Node values are written into the frame as they change, so only effects processing is required here
 	for(auto& dev : controller.getDevices()) {
 		if(dev.type() != DeviceType::DMX512) {
 			continue;
@@ -100,25 +89,17 @@ void Device::updateSlaves()
 		if(dmxDevice.update()) {
 			dataChanged = true;
 		}
-
-		for(unsigned nodeId = dev.nodeIdMin(); nodeId <= dev.nodeIdMax(); ++nodeId) {
-			auto& nodeData = dmxDevice.getNodeData(nodeId);
-			unsigned addr = dev.address() + nodeId;
-			assert(addr > 0 && addr <= maxAddr);
-			// @todo: Device should perform any necessary translation
-			//			data[addr] = led(nodeData.value);
-			data[addr] = nodeData.value;
-		}
 	}
 
-	debug_hex(DBG, ">", data, dataSize, 0, 32);
+	debug_hex(DBG, ">", universe->getFrame(), universe->getFrameSize(), 0, 32);
 
+	// Slot #0 is the start code, always 0 for lighting applications
 	getController().setDirection(Direction::Outgoing);
 	serial.setBreak(true);
-	delayMicroseconds(DMX_BREAK);
+	Clock::delayMicroseconds(DMX_BREAK);
 	serial.setBreak(false);
-	delayMicroseconds(DMX_MAB);
-	serial.write(data, dataSize);
+	Clock::delayMicroseconds(DMX_MAB);
+	serial.write(universe->getFrame(), universe->getFrameSize());
 	uint8_t c{0};
 	serial.write(&c, 1);
 
@@ -133,6 +114,17 @@ ErrorCode Device::init(const Config& config)
 	}
 	nodeCount = config.nodeCount ?: 1;
 	nodeData.reset(new NodeData[nodeCount]{});
+	activeStart = nodeCount;
+	activeEnd = 0;
+
+	universe = getController().getDmxUniverse();
+	if(universe == nullptr) {
+		return Error::no_mem;
+	}
+	assert(address() > 0 && address() + nodeCount - 1 <= Universe::MaxSlots);
+	for(unsigned id = 0; id < nodeCount; ++id) {
+		writeSlot(id);
+	}
 
 	auto& serial = getController().getSerial();
 	if(!serial.resizeBuffers(0, MaxPacketSize)) {
@@ -143,6 +135,12 @@ ErrorCode Device::init(const Config& config)
 		[](void* arg) {
 			auto dev = static_cast<Device*>(arg);
 			auto req = dev->createRequest();
+			if(req == nullptr) {
+				// Try again later
+				debug_w("[DMX512] Update deferred: %s", Error::toString(dev->getCreateError()).c_str());
+				timer.startOnce();
+				return;
+			}
 			req->setCommand(Command::update);
 			req->submit();
 		},
@@ -153,11 +151,29 @@ ErrorCode Device::init(const Config& config)
 	return Error::success;
 }
 
+Serial::Config Device::getSerialConfig() const
+{
+	return Serial::Config{
+		.baudrate = DMX_BAUDRATE,
+		.format = DMX_SERIAL_FORMAT,
+	};
+}
+
 IO::Request* Device::createRequest()
 {
 	return new Request(*this);
 }
 
+RequestPool* Device::getRequestPool() const
+{
+	return &Request::pool;
+}
+
+RequestPool* Device::Factory::getRequestPool() const
+{
+	return &Request::pool;
+}
+
 void Device::parseJson(JsonObjectConst json, Config& cfg)
 {
 	IO::RS485::Device::parseJson(json, cfg.rs485);
@@ -180,11 +196,21 @@ ErrorCode Device::init(JsonObjectConst config)
 bool Device::update()
 {
 	bool res = false;
-	for(unsigned i = 0; i < nodeCount; ++i) {
-		if(nodeData[i].adjust()) {
+	uint8_t start = nodeCount;
+	uint8_t end = 0;
+	for(unsigned i = activeStart; i < activeEnd; ++i) {
+		auto& data = nodeData[i];
+		if(data.adjust()) {
+			writeSlot(i);
 			res = true;
 		}
+		if(data.isActive()) {
+			start = std::min(start, uint8_t(i));
+			end = i + 1;
+		}
 	}
+	activeStart = start;
+	activeEnd = end;
 	return res;
 }
 
@@ -249,9 +275,14 @@ ErrorCode Device::execute(Request& request)
 			break;
 		case Command::set:
 			data.setValue(request.getValue());
+			writeSlot(nodeId);
 			break;
 		default:
 			err = Error::bad_command;
+			return;
+		}
+		if(data.isActive()) {
+			setActive(nodeId);
 		}
 	};
 
@@ -21,12 +21,13 @@
 
 #include <IO/DMX512/Request.h>
 #include <IO/Strings.h>
-#include <SimpleTimer.h>
 
 namespace IO
 {
 namespace DMX512
 {
+RequestPool Request::pool{sizeof(Request)};
+
 /*
  * We don't need to use the queue as requests do not perform any I/O.
  * Instead, device state is updated and echoed on next slave update.
@@ -21,6 +21,7 @@
 #include <IO/Request.h>
 #include <IO/Controller.h>
 #include <IO/Strings.h>
+#include <IO/Clock.h>
 
 namespace IO
 {
@@ -31,12 +32,18 @@ ErrorCode Device::init(const Config& config)
 	}
 
 	name = config.name;
+	queueLimit = config.queueLimit;
+	breaker.setThreshold(config.breakerThreshold);
+	pollInterval = config.pollInterval;
 	return Error::success;
 }
 
 void Device::parseJson(JsonObjectConst json, Config& cfg)
 {
 	cfg.name = json[FS_name].as<const char*>();
+	cfg.queueLimit = json[FS_queue] | 0;
+	cfg.breakerThreshold = json[FS_breaker] | CIRCUIT_BREAKER_THRESHOLD;
+	cfg.pollInterval = json[FS_poll] | 0;
 }
 
 /*
@@ -56,7 +63,7 @@ ErrorCode Device::start()
 
 	auto req = createRequest();
 	if(req == nullptr) {
-		return Error::no_mem;
+		return getCreateError();
 	}
 
 	// This fails if device doesn't have any nodes
@@ -67,12 +74,77 @@ ErrorCode Device::start()
 	}
 
 	req->setID(F("query"));
-	req->submit();
+	req->setPriority(Priority::background);
+	// Request may be rejected and completed before submit() returns
 	state = State::starting;
+	startRequest = req;
+	req->submit();
 
 	return Error::success;
 }
 
+/*
+ * Issue a background state query.
+ * If the last one is still waiting there's no point queueing another.
+ */
+void Device::poll(uint32_t due)
+{
+	if(state != State::normal) {
+		// Device start-up or restart queries state anyway
+		return;
+	}
+
+	if(pollPending) {
+		debug_d("[IO] %s poll skipped", caption().c_str());
+		++pollStats.missed;
+		return;
+	}
+
+	auto req = createRequest();
+	if(req == nullptr) {
+		++pollStats.missed;
+		return;
+	}
+
+	if(!req->nodeQuery(DevNode_ALL)) {
+		// Device doesn't have any nodes
+		delete req;
+		pollInterval = 0;
+		return;
+	}
+
+	req->setID(F("poll"));
+	req->setPriority(Priority::background);
+	// Stale results are no use
+	req->setDeadline(pollInterval);
+	req->onComplete([this](const Request& request) { pollComplete(request); });
+	pollPending = true;
+	pollDue = due;
+	req->submit();
+}
+
+void Device::pollComplete(const Request& request)
+{
+	pollPending = false;
+	if(request.error()) {
+		++pollStats.missed;
+		return;
+	}
+
+	uint32_t lag = Clock::millis() - pollDue;
+	++pollStats.count;
+	pollStats.totalLag += lag;
+	pollStats.maxLag = std::max(pollStats.maxLag, lag);
+}
+
+void Device::getPollStats(JsonObject json) const
+{
+	json[FS_count] = pollStats.count;
+	json[FS_missed] = pollStats.missed;
+	json[FS_avg] = pollStats.averageLag();
+	json[FS_max] = pollStats.maxLag;
+}
+
 /*
  * Inherited classes might override this method to place device in a low-power state.
  */
@@ -86,10 +158,40 @@ void Device::submit(Request* request)
 	controller.submit(request);
 }
 
+bool Device::cancel(Request* request)
+{
+	return controller.cancel(request);
+}
+
+void Device::holdRequest(Request& holder, Request& request)
+{
+	controller.hold(holder, request);
+}
+
+void Device::releaseRequest(Request& holder)
+{
+	controller.release(holder);
+}
+
 void Device::handleEvent(Request* request, Event event)
 {
 	if(event == Event::RequestComplete) {
-		if(request->error()) {
+		/*
+		 * Requests which never reached the device (rejected, cancelled or expired) don't indicate a fault,
+		 * but a start-up request must be retried.
+		 */
+		auto err = request->error();
+		bool executed = (request == controller.activeRequest);
+		bool isStart = (request == startRequest);
+		if(isStart) {
+			startRequest = nullptr;
+		}
+		if(executed) {
+			breaker.recordResult(err, Clock::millis());
+		}
+		if(err && !executed && !isStart) {
+			// Nothing to do
+		} else if(err) {
 			state = State::fault;
 			controller.deviceError(*this);
 		} else if(state == State::starting) {
@@ -32,6 +32,8 @@ void DeviceManager::registerController(Controller& controller)
 	id += controller.instance;
 	controller.id = id;
 	controllers.add(&controller);
+	controllerIndex.clear();
+	deviceIndex.clear();
 	debug_i("Controller '%s' registered", controller.getId().c_str());
 }
 
@@ -42,6 +44,35 @@ ErrorCode DeviceManager::begin(JsonObjectConst config)
 		return err;
 	}
 
+	// Size request pools
+	JsonObjectConst pools = config[FS_pools];
+	for(JsonPairConst pool : pools) {
+		auto factory = Controller::findDeviceClass(pool.key().c_str());
+		auto requestPool = factory ? factory->getRequestPool() : nullptr;
+		if(requestPool == nullptr) {
+			debug_w("[IO] No request pool for device class '%s'", pool.key().c_str());
+			continue;
+		}
+		auto poolErr = requestPool->setCapacity(pool.value().as<unsigned>());
+		if(poolErr) {
+			// Not fatal: a pool which failed to allocate passes requests through to the heap
+			err = poolErr;
+			debug_err(err, String(pool.key().c_str()));
+		}
+	}
+
+	// Set controller queue limits
+	JsonObjectConst ctrls = config[FS_controllers];
+	for(JsonPairConst ctrl : ctrls) {
+		auto controller = findController(ctrl.key().c_str());
+		if(controller == nullptr) {
+			debug_err(Error::bad_controller, String(ctrl.key().c_str()));
+			continue;
+		}
+		controller->setQueueLimits(ctrl.value()[FS_queue] | 0, ctrl.value()[FS_highwater] | 0);
+		controller->setBatchLimit(ctrl.value()[FS_batch] | 0);
+	}
+
 	// Create devices
 	JsonObjectConst devices = config[FS_devices];
 	for(JsonPairConst dev : devices) {
@@ -58,11 +89,57 @@ ErrorCode DeviceManager::begin(JsonObjectConst config)
 		controller->createDevice(dev.key().c_str(), dev.value(), inst);
 	}
 
+	buildIndex();
 	start();
 
 	return err;
 }
 
+/*
+ * Index is rebuilt on demand after any changes
+ */
+bool DeviceManager::buildIndex()
+{
+	if(!controllerIndex.isValid() && controllerIndex.reset(controllers.count())) {
+		for(auto& controller : controllers) {
+			controllerIndex.add(controller);
+		}
+	}
+
+	if(!deviceIndex.isValid()) {
+		size_t count{0};
+		for(auto& controller : controllers) {
+			count += controller.getDevices().count();
+		}
+		if(deviceIndex.reset(count)) {
+			for(auto& controller : controllers) {
+				for(auto& device : controller.getDevices()) {
+					deviceIndex.add(device);
+				}
+			}
+		}
+	}
+
+	return controllerIndex.isValid() && deviceIndex.isValid();
+}
+
+Controller* DeviceManager::findController(const char* id, size_t length)
+{
+	if(buildIndex()) {
+		return controllerIndex.find(id, length);
+	}
+
+	// Fall back to linear search if index can't be built
+	for(auto& controller : controllers) {
+		auto& ctrlid = controller.getId();
+		if(ctrlid.length() == length && memcmp(ctrlid.c_str(), id, length) == 0) {
+			return &controller;
+		}
+	}
+
+	return nullptr;
+}
+
 void DeviceManager::start()
 {
 	// Start all controllers
@@ -111,22 +188,88 @@ ErrorCode DeviceManager::end()
 	return Error::success;
 }
 
-Device* DeviceManager::findDevice(const String& id)
+Device* DeviceManager::findDevice(const char* id, size_t length)
 {
+	Device* device{nullptr};
+	if(buildIndex()) {
+		device = deviceIndex.find(id, length);
+	} else {
+		for(auto& controller : controllers) {
+			device = controller.findDevice(id, length);
+			if(device != nullptr) {
+				break;
+			}
+		}
+	}
+
+	if(device == nullptr) {
+		debug_e("Device '%.*s' not registered", int(length), id);
+	}
+	return device;
+}
+
+void DeviceManager::getPoolStats(JsonObject json) const
+{
+	for(auto factory : Controller::deviceClasses) {
+		auto pool = factory->getRequestPool();
+		if(pool != nullptr) {
+			pool->getJson(json.createNestedObject(String(factory->deviceClass())));
+		}
+	}
+}
+
+void DeviceManager::getLatencyStats(JsonObject json) const
+{
+	JsonObject ctrls = json.createNestedObject(FS_controllers);
+	JsonObject devs = json.createNestedObject(FS_devices);
 	for(auto& controller : controllers) {
-		auto device = controller.findDevice(id);
-		if(device != nullptr) {
-			return device;
+		controller.getLatencyStats().getJson(ctrls.createNestedObject(controller.getId().c_str()));
+		for(auto& device : controller.getDevices()) {
+			device.getLatencyStats().getJson(devs.createNestedObject(device.getId().c_str()));
 		}
 	}
+}
 
-	debug_e("Device '%s' not registered", id.c_str());
-	return nullptr;
+uint16_t DeviceManager::addListener(Request::Callback callback, const RequestFilter& filter)
+{
+	auto listener = new Listener;
+	if(listener == nullptr) {
+		return 0;
+	}
+
+	listener->callback = callback;
+	listener->filter = filter;
+	return listeners.add(listener);
+}
+
+bool DeviceManager::removeListener(uint16_t id)
+{
+	return listeners.remove(id);
+}
+
+void DeviceManager::invokeListeners(Request& request)
+{
+	auto phase = request.isPending() ? RequestFilter::Phase::execute : RequestFilter::Phase::complete;
+
+	listeners.dispatch([&](Listener& listener) {
+		if(listener.filter.matches(request, phase)) {
+			listener.callback(request);
+		}
+	});
 }
 
-ErrorCode DeviceManager::createRequest(const String& devid, Request*& request)
+unsigned DeviceManager::cancelRequests(const String& requestId)
 {
-	if(!devid) {
+	unsigned count{0};
+	for(auto& controller : controllers) {
+		count += controller.cancelRequests(requestId);
+	}
+	return count;
+}
+
+ErrorCode DeviceManager::createRequest(const char* devid, Request*& request)
+{
+	if(devid == nullptr || *devid == '\0') {
 		return Error::no_device_id;
 	}
 
@@ -136,7 +279,7 @@ ErrorCode DeviceManager::createRequest(const String& devid, Request*& request)
 	}
 
 	request = dev->createRequest();
-	return request ? Error::success : Error::no_mem;
+	return request ? Error::success : dev->getCreateError();
 }
 
 /*
@@ -163,6 +306,12 @@ ErrorCode DeviceManager::handleMessage(JsonObject json, Request::Callback callba
 			return setError(json, err, s);
 		}
 
+		Priority priority = Priority::normal;
+		if(Json::getValue(json[FS_priority], s) && !fromString(priority, s)) {
+			err = Error::bad_param;
+			return setError(json, err, s);
+		}
+
 		JsonArray arr = json[isDevnode ? FS_devnodes : FS_devices];
 		String requestId = json[FS_id];
 
@@ -171,7 +320,7 @@ ErrorCode DeviceManager::handleMessage(JsonObject json, Request::Callback callba
 
 		for(auto obj : arr) {
 			if(isDevnode) {
-				err = createRequest(obj[FS_device], req);
+				err = createRequest(obj[FS_device].as<const char*>(), req);
 				if(err) {
 					setError(obj, err);
 					break;
@@ -179,6 +328,7 @@ ErrorCode DeviceManager::handleMessage(JsonObject json, Request::Callback callba
 
 				req->setID(requestId);
 				req->onComplete(callback);
+				req->setPriority(priority);
 				if(cmd != Command::undefined) {
 					req->setCommand(cmd);
 				}
@@ -189,7 +339,7 @@ ErrorCode DeviceManager::handleMessage(JsonObject json, Request::Callback callba
 					break;
 				}
 			} else {
-				err = createRequest(obj, req);
+				err = createRequest(obj.as<const char*>(), req);
 				if(err) {
 					setError(json, err);
 					break;
@@ -197,6 +347,7 @@ ErrorCode DeviceManager::handleMessage(JsonObject json, Request::Callback callba
 
 				req->setID(requestId);
 				req->onComplete(callback);
+				req->setPriority(priority);
 				req->setCommand(cmd);
 				req->setNode(DevNode_ALL);
 			}
@@ -226,7 +377,7 @@ ErrorCode DeviceManager::handleMessage(JsonObject json, Request::Callback callba
 		}
 	} else {
 		// Single request
-		err = createRequest(json[FS_device], req);
+		err = createRequest(json[FS_device].as<const char*>(), req);
 		if(err) {
 			return setError(json, err, nullptr, json[FS_device]);
 		}
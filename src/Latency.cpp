@@ -0,0 +1,109 @@
+/**
+ * Latency.cpp
+ *
+ * Copyright 2022 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the IOControl Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#include <IO/Latency.h>
+#include <IO/Request.h>
+#include <IO/Strings.h>
+
+namespace IO
+{
+DEFINE_FSTR_LOCAL(FS_p50, "p50")
+DEFINE_FSTR_LOCAL(FS_p90, "p90")
+DEFINE_FSTR_LOCAL(FS_p99, "p99")
+DEFINE_FSTR_LOCAL(FS_buckets, "buckets")
+DEFINE_FSTR_LOCAL(FS_wait, "wait")
+DEFINE_FSTR_LOCAL(FS_transmit, "transmit")
+DEFINE_FSTR_LOCAL(FS_response, "response")
+DEFINE_FSTR_LOCAL(FS_total, "total")
+
+void LatencyHistogram::add(uint32_t us)
+{
+	unsigned bucket{0};
+	if(us >= bucketLimit(0)) {
+		bucket = std::min(32 - __builtin_clz(us) - MIN_SHIFT, BUCKET_COUNT - 1);
+	}
+	if(buckets[bucket] != UINT16_MAX) {
+		++buckets[bucket];
+	}
+	++count;
+	sum += us;
+	max = std::max(max, us);
+}
+
+uint32_t LatencyHistogram::getPercentile(unsigned percent) const
+{
+	if(count == 0) {
+		return 0;
+	}
+
+	uint32_t total{0};
+	for(auto n : buckets) {
+		total += n;
+	}
+	uint32_t target = (uint64_t(total) * percent + 99) / 100;
+	uint32_t n{0};
+	for(unsigned i = 0; i < BUCKET_COUNT - 1; ++i) {
+		n += buckets[i];
+		if(n >= target) {
+			return std::min(bucketLimit(i), max);
+		}
+	}
+	return max;
+}
+
+void LatencyHistogram::getJson(JsonObject json) const
+{
+	json[FS_count] = count;
+	json[FS_avg] = getAverage();
+	json[FS_max] = max;
+	json[FS_p50] = getPercentile(50);
+	json[FS_p90] = getPercentile(90);
+	json[FS_p99] = getPercentile(99);
+	JsonArray arr = json.createNestedArray(FS_buckets);
+	for(auto n : buckets) {
+		arr.add(n);
+	}
+}
+
+/*
+ * Transmit and receive times are those of the last transaction for requests which take more than one.
+ * Devices which don't report them only contribute to wait and total times.
+ */
+void LatencyStats::add(const Request& request, uint32_t now)
+{
+	auto& t = request.getTiming();
+	wait.add(t.execute - t.submit);
+	if(t.transmit != 0) {
+		transmit.add(t.transmit - t.execute);
+		if(t.receive != 0) {
+			response.add(t.receive - t.transmit);
+		}
+	}
+	total.add(now - t.submit);
+}
+
+void LatencyStats::getJson(JsonObject json) const
+{
+	wait.getJson(json.createNestedObject(FS_wait));
+	transmit.getJson(json.createNestedObject(FS_transmit));
+	response.getJson(json.createNestedObject(FS_response));
+	total.getJson(json.createNestedObject(FS_total));
+}
+
+} // namespace IO
@@ -18,36 +18,9 @@
  ****/
 
 #include <IO/Modbus/ADU.h>
+#include <IO/Modbus/CRC16.h>
 #include <debug_progmem.h>
 
-namespace
-{
-uint16_t crc16_update(uint16_t crc, uint8_t a)
-{
-	crc ^= a;
-
-	for(unsigned i = 0; i < 8; ++i) {
-		if(crc & 1)
-			crc = (crc >> 1) ^ 0xA001;
-		else
-			crc = (crc >> 1);
-	}
-
-	return crc;
-}
-
-uint16_t crc16_update(uint16_t crc, const void* data, size_t count)
-{
-	auto p = static_cast<const uint8_t*>(data);
-	while(count--) {
-		crc = crc16_update(crc, *p++);
-	}
-
-	return crc;
-}
-
-} // namespace
-
 namespace IO
 {
 namespace Modbus
@@ -77,7 +50,7 @@ size_t ADU::preparePacket(size_t pduSize)
 		return 0;
 	}
 
-	auto crc = crc16_update(0xFFFF, buffer, size);
+	auto crc = CRC16::calculate(buffer, size);
 	buffer[size++] = uint8_t(crc);
 	buffer[size++] = uint8_t(crc >> 8);
 
@@ -122,7 +95,7 @@ ErrorCode ADU::parsePacket(size_t receivedSize, size_t pduSize)
 
 	debug_hex(DBG, "<", buffer, aduSize);
 
-	auto crc = crc16_update(0xFFFF, buffer, aduSize);
+	auto crc = CRC16::calculate(buffer, aduSize);
 	if(crc != 0) {
 		return Error::bad_checksum;
 	}
@@ -0,0 +1,138 @@
+/**
+ * CRC16.cpp
+ *
+ * Copyright 2022 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the IOControl Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#include <IO/Modbus/CRC16.h>
+#include <FakePgmSpace.h>
+
+#if defined(IOCONTROL_CRC16_slice4) || defined(IOCONTROL_CRC16_slice8)
+#ifndef ARCH_HOST
+#error "CRC16 slicing implementations are only available for Host builds"
+#endif
+#endif
+
+namespace
+{
+constexpr uint16_t POLYNOMIAL{0xA001};
+
+constexpr uint16_t crc16_byte(uint16_t crc, uint8_t a)
+{
+	crc ^= a;
+	for(unsigned i = 0; i < 8; ++i) {
+		crc = (crc & 1) ? (crc >> 1) ^ POLYNOMIAL : (crc >> 1);
+	}
+	return crc;
+}
+
+/*
+ * Table k gives the effect of a byte followed by k zero bytes
+ */
+template <unsigned slices> struct Table {
+	uint16_t entries[slices][256];
+
+	constexpr Table() : entries{}
+	{
+		for(unsigned n = 0; n < 256; ++n) {
+			entries[0][n] = crc16_byte(0, n);
+		}
+		for(unsigned k = 1; k < slices; ++k) {
+			for(unsigned n = 0; n < 256; ++n) {
+				auto prev = entries[k - 1][n];
+				entries[k][n] = (prev >> 8) ^ entries[0][prev & 0xff];
+			}
+		}
+	}
+};
+
+const Table<1> crcTable PROGMEM;
+
+#ifdef ARCH_HOST
+const Table<8> sliceTable;
+
+template <unsigned slices> uint16_t updateSliced(uint16_t crc, const void* data, size_t count)
+{
+	auto& t = sliceTable.entries;
+	auto p = static_cast<const uint8_t*>(data);
+	for(; count >= slices; count -= slices, p += slices) {
+		uint16_t c = t[slices - 1][(crc ^ p[0]) & 0xff] ^ t[slices - 2][(crc >> 8) ^ p[1]];
+		for(unsigned i = 2; i < slices; ++i) {
+			c ^= t[slices - 1 - i][p[i]];
+		}
+		crc = c;
+	}
+	while(count--) {
+		crc = (crc >> 8) ^ t[0][(crc ^ *p++) & 0xff];
+	}
+	return crc;
+}
+#endif
+
+} // namespace
+
+namespace IO
+{
+namespace Modbus
+{
+namespace CRC16
+{
+uint16_t updateBitwise(uint16_t crc, const void* data, size_t count)
+{
+	auto p = static_cast<const uint8_t*>(data);
+	while(count--) {
+		crc = crc16_byte(crc, *p++);
+	}
+	return crc;
+}
+
+uint16_t updateTable(uint16_t crc, const void* data, size_t count)
+{
+	auto p = static_cast<const uint8_t*>(data);
+	while(count--) {
+		crc = (crc >> 8) ^ pgm_read_word(&crcTable.entries[0][(crc ^ *p++) & 0xff]);
+	}
+	return crc;
+}
+
+#ifdef ARCH_HOST
+uint16_t updateSlice4(uint16_t crc, const void* data, size_t count)
+{
+	return updateSliced<4>(crc, data, count);
+}
+
+uint16_t updateSlice8(uint16_t crc, const void* data, size_t count)
+{
+	return updateSliced<8>(crc, data, count);
+}
+#endif
+
+uint16_t update(uint16_t crc, const void* data, size_t count)
+{
+#if defined(IOCONTROL_CRC16_bitwise)
+	return updateBitwise(crc, data, count);
+#elif defined(IOCONTROL_CRC16_slice4)
+	return updateSlice4(crc, data, count);
+#elif defined(IOCONTROL_CRC16_slice8)
+	return updateSlice8(crc, data, count);
+#else
+	return updateTable(crc, data, count);
+#endif
+}
+
+} // namespace CRC16
+} // namespace Modbus
+} // namespace IO
@@ -27,7 +27,25 @@ namespace IO
 {
 namespace Modbus
 {
-ErrorCode Device::init(const RS485::Device::Config& config)
+namespace
+{
+bool canBroadcast(Function function)
+{
+	switch(function) {
+	case Function::WriteSingleCoil:
+	case Function::WriteSingleRegister:
+	case Function::WriteMultipleCoils:
+	case Function::WriteMultipleRegisters:
+	case Function::MaskWriteRegister:
+		return true;
+	default:
+		return false;
+	}
+}
+
+} // namespace
+
+ErrorCode Device::init(const Config& config)
 {
 	auto& ctrl = static_cast<IO::RS485::Controller&>(controller);
 	if(!ctrl.getSerial().resizeBuffers(ADU::MaxSize, ADU::MaxSize)) {
@@ -35,7 +53,42 @@ ErrorCode Device::init(const RS485::Device::Config& config)
 		//		return Error::no_mem;
 	}
 
-	return IO::RS485::Device::init(config);
+	auto err = IO::RS485::Device::init(config.rs485);
+	if(err) {
+		return err;
+	}
+
+	if(config.writeBehind == 0) {
+		writeCache.reset();
+	} else {
+		writeCache.reset(new WriteCache(*this, config.writeBehind));
+		if(!writeCache) {
+			return Error::no_mem;
+		}
+	}
+
+	return Error::success;
+}
+
+/*
+ * New requests pass through the write-behind cache, if enabled
+ */
+bool Device::deferRequest(IO::Request& request)
+{
+	return writeCache && writeCache->submit(static_cast<Request&>(request));
+}
+
+ErrorCode Device::init(JsonObjectConst config)
+{
+	Config cfg{};
+	parseJson(config, cfg);
+	return init(cfg);
+}
+
+void Device::parseJson(JsonObjectConst json, Config& cfg)
+{
+	IO::RS485::Device::parseJson(json, cfg.rs485);
+	cfg.writeBehind = json[FS_writebehind];
 }
 
 void Device::handleEvent(IO::Request* request, Event event)
@@ -54,6 +107,12 @@ void Device::handleEvent(IO::Request* request, Event event)
 	}
 
 	case Event::ReceiveComplete: {
+		if(req->isBroadcast()) {
+			// Line noise: discard and restart the turnaround timer, which receive handling stopped
+			getController().getSerial().clear(UART_RX_ONLY);
+			getController().setTimeout(BROADCAST_TURNAROUND_DELAY);
+			return;
+		}
 		auto err = readResponse(req);
 		if(err != Error::pending) {
 			request->complete(err);
@@ -62,11 +121,27 @@ void Device::handleEvent(IO::Request* request, Event event)
 	}
 
 	case Event::TransmitComplete:
+		if(req->isBroadcast() && !turnaround) {
+			// No response, just give slaves time to act on it
+			turnaround = true;
+			getController().setTimeout(BROADCAST_TURNAROUND_DELAY);
+		}
+		break;
+
 	case Event::Timeout:
+		if(turnaround) {
+			turnaround = false;
+			auto err = completeBroadcast(req);
+			if(err != Error::pending) {
+				request->complete(err);
+			}
+			return;
+		}
 		break;
 
 	case Event::RequestComplete:
 		requestFunction = Function::None;
+		turnaround = false;
 		break;
 	}
 
@@ -87,27 +162,52 @@ ErrorCode Device::execute(Request* request)
 	// Fill out the ADU packet
 	ADU adu;
 	requestFunction = request->fillRequestData(adu.pdu.data);
+	if(requestFunction == Function::None) {
+		return Error::bad_command;
+	}
 	adu.pdu.setFunction(requestFunction);
-	adu.slaveAddress = request->device.address();
+	turnaround = false;
+	size_t responseSize;
+	if(request->isBroadcast()) {
+		if(!canBroadcast(requestFunction)) {
+			return Error::bad_command;
+		}
+		adu.slaveAddress = ADU::BROADCAST_ADDRESS;
+		// Write responses echo start of request
+		memcpy(broadcastData, &adu.pdu.data, sizeof(broadcastData));
+		responseSize = 0;
+	} else {
+		adu.slaveAddress = request->device.address();
+		responseSize = adu.pdu.getExpectedResponseSize();
+	}
 	auto aduSize = adu.prepareRequest();
 	if(aduSize == 0) {
 		return Error::bad_size;
 	}
 
 	// Prepare UART for comms
-	IO::Serial::Config cfg{
-		.baudrate = baudrate(),
-		.format = UART_8N1,
-	};
-	auto& serial = getController().getSerial();
-	serial.setConfig(cfg);
-	serial.clear();
+	getController().setConfig(getSerialConfig());
+	getController().getSerial().clear();
+
+	// Receive completes as soon as full response arrives: slave address + PDU + CRC
+	getController().expectResponse(responseSize ? 1 + responseSize + 2 : 0);
 
 	// OK, issue the request
 	getController().send(adu.buffer, aduSize);
 	return Error::pending;
 }
 
+/*
+ * Slaves don't respond to broadcasts so construct the response a slave would have sent
+ */
+ErrorCode Device::completeBroadcast(Request* request)
+{
+	PDU pdu{};
+	pdu.setFunction(requestFunction);
+	memcpy(&pdu.data, broadcastData, sizeof(broadcastData));
+	return request->callback(pdu);
+}
+
 ErrorCode Device::readResponse(Request* request)
 {
 	// Read packet
@@ -140,6 +140,45 @@ size_t PDU::getResponseDataSize() const
 	}
 }
 
+size_t PDU::getExpectedResponseSize() const
+{
+	switch(function()) {
+	case Function::ReadCoils:
+		return 2 + (data.readCoils.request.quantityOfCoils + 7) / 8;
+
+	case Function::ReadDiscreteInputs:
+		return 2 + (data.readDiscreteInputs.request.quantityOfInputs + 7) / 8;
+
+	case Function::ReadHoldingRegisters:
+		return 2 + data.readHoldingRegisters.request.quantityOfRegisters * 2;
+
+	case Function::ReadInputRegisters:
+		return 2 + data.readInputRegisters.request.quantityOfRegisters * 2;
+
+	case Function::ReadWriteMultipleRegisters:
+		return 2 + data.readWriteMultipleRegisters.request.quantityToRead * 2;
+
+	case Function::WriteSingleCoil:
+	case Function::WriteSingleRegister:
+	case Function::WriteMultipleCoils:
+	case Function::WriteMultipleRegisters:
+	case Function::GetComEventCounter:
+		return 5;
+
+	case Function::MaskWriteRegister:
+		return 7;
+
+	case Function::ReadExceptionStatus:
+		return 2;
+
+	// Variable length
+	case Function::GetComEventLog:
+	case Function::ReportServerId:
+	default:
+		return 0;
+	}
+}
+
 void PDU::swapRequestByteOrder()
 {
 	if(exceptionFlag()) {
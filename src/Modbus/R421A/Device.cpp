@@ -63,19 +63,52 @@ IO::Request* Device::createRequest()
 	return new Request(*this);
 }
 
+RequestPool* Device::getRequestPool() const
+{
+	return &Request::pool;
+}
+
+RequestPool* Device::Factory::getRequestPool() const
+{
+	return &Request::pool;
+}
+
 void Device::handleEvent(IO::Request* request, Event event)
 {
-	if(event == Event::RequestComplete && !request->error()) {
-		// Keep track of channel states
-		auto& rsp = reinterpret_cast<Request*>(request)->getResponse();
-		states.channelMask += rsp.channelMask;
-		states.channelStates -= rsp.channelMask;
-		states.channelStates += rsp.channelStates;
+	if(event == Event::RequestComplete) {
+		auto req = reinterpret_cast<Request*>(request);
+		auto transactions = req->getTransactionCount();
+		if(transactions != 0) {
+			auto& stats = commandStats[unsigned(req->getCommand())];
+			++stats.count;
+			stats.transactions += transactions;
+		}
+
+		if(!request->error()) {
+			// Keep track of channel states
+			auto& rsp = req->getResponse();
+			states.channelMask += rsp.channelMask;
+			states.channelStates -= rsp.channelMask;
+			states.channelStates += rsp.channelStates;
+		}
 	}
 
 	IO::Modbus::Device::handleEvent(request, event);
 }
 
+void Device::getCommandStats(JsonObject json) const
+{
+	for(unsigned i = 0; i < COMMAND_COUNT; ++i) {
+		auto& stats = commandStats[i];
+		if(stats.count == 0) {
+			continue;
+		}
+		JsonObject obj = json.createNestedObject(toString(Command(i)));
+		obj[FS_count] = stats.count;
+		obj[FS_transactions] = stats.transactions;
+	}
+}
+
 DevNode::States Device::getNodeStates(DevNode node) const
 {
 	if(node == DevNode_ALL) {
@@ -26,6 +26,8 @@ namespace Modbus
 {
 namespace R421A
 {
+RequestPool Request::pool{sizeof(Request)};
+
 enum r421a_command_t {
 	r421_query = 0x00,
 	r421_close = 0x01,
@@ -34,6 +36,8 @@ enum r421a_command_t {
 	r421_latch = 0x04,
 	r421_momentary = 0x05,
 	r421_delay = 0x06,
+	r421_close_all = 0x07, ///< Address ignored
+	r421_open_all = 0x08,  ///< Address ignored
 	//
 	r421_on = r421_close,
 	r421_off = r421_open,
@@ -76,6 +80,28 @@ static r421a_command_t map(Command cmd)
  * We'll use 32 bits for this.
  */
 Function Request::fillRequestData(PDU::Data& data)
+{
+	auto function = fillChannelData(data);
+	if(function != Function::None) {
+		++transactionCount;
+	}
+	return function;
+}
+
+/*
+ * Determine whether request covers every channel on the device
+ */
+bool Request::isAllChannels() const
+{
+	for(auto ch = device.nodeIdMin(); ch <= device.nodeIdMax(); ++ch) {
+		if(!commandData.channelMask[ch]) {
+			return false;
+		}
+	}
+	return true;
+}
+
+Function Request::fillChannelData(PDU::Data& data)
 {
 	if(getCommand() == Command::query) {
 		// Query all channels
@@ -85,6 +111,14 @@ Function Request::fillRequestData(PDU::Data& data)
 		return Function::ReadHoldingRegisters;
 	}
 
+	// All channels on or off in one go
+	if((getCommand() == Command::on || getCommand() == Command::off) && isAllChannels()) {
+		auto& req = data.writeSingleRegister.request;
+		req.address = 0;
+		req.value = ((getCommand() == Command::on) ? r421_close_all : r421_open_all) << 8;
+		return Function::WriteSingleRegister;
+	}
+
 	// others
 	for(auto ch = device.nodeIdMin(); ch <= device.nodeIdMax(); ++ch) {
 		if(commandData.channelMask[ch]) {
@@ -134,6 +168,16 @@ ErrorCode Request::callback(PDU& pdu)
 	case Function::WriteSingleRegister: {
 		// Other commands
 		auto& rsp = pdu.data.writeSingleRegister.response;
+		if(rsp.address == 0) {
+			// All channels
+			for(auto ch = device.nodeIdMin(); ch <= device.nodeIdMax(); ++ch) {
+				response.channelMask[ch] = true;
+				response.channelStates[ch] = (getCommand() == Command::on);
+			}
+			commandData.channelMask = BitSet32{};
+			break;
+		}
+
 		uint8_t ch = rsp.address;
 		// We've handled this channel, clear command mask bit
 		commandData.channelMask[ch] = false;
@@ -164,6 +208,57 @@ ErrorCode Request::callback(PDU& pdu)
 	return Error::success;
 }
 
+/*
+ * A query always reads all channels, so two queries are equivalent.
+ * An on/off command for a set of channels is equivalent to the same command already queued,
+ * and makes any queued on/off/toggle for a subset of those channels redundant.
+ */
+IO::Request::Merge Request::checkMerge(const IO::Request& other) const
+{
+	if(&other.device != &device) {
+		return Merge::none;
+	}
+
+	auto cmd = getCommand();
+	auto otherCmd = other.getCommand();
+	if(cmd == Command::query) {
+		if(otherCmd != Command::query) {
+			return Merge::none;
+		}
+	} else if(cmd == Command::on || cmd == Command::off) {
+		if(otherCmd != Command::on && otherCmd != Command::off && otherCmd != Command::toggle) {
+			return Merge::none;
+		}
+	} else {
+		return Merge::none;
+	}
+
+	// Only requests of this class issue these commands
+	auto& req = static_cast<const Request&>(other);
+	if(isBroadcast() != req.isBroadcast()) {
+		return Merge::none;
+	}
+
+	if(cmd == Command::query) {
+		return Merge::duplicate;
+	}
+
+	if(cmd == otherCmd && commandData.channelMask == req.commandData.channelMask) {
+		return Merge::duplicate;
+	}
+
+	if((req.commandData.channelMask - commandData.channelMask).any()) {
+		return Merge::none;
+	}
+
+	return Merge::supersede;
+}
+
+void Request::copyResult(const IO::Request& other)
+{
+	response = static_cast<const Request&>(other).response;
+}
+
 bool Request::setNode(DevNode node)
 {
 	if(node == DevNode_ALL) {
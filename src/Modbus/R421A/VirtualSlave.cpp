@@ -0,0 +1,108 @@
+/**
+ * Modbus/R421A/VirtualSlave.cpp
+ *
+ * Copyright 2022 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the IOControl Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#include <IO/Modbus/R421A/VirtualSlave.h>
+
+namespace IO
+{
+namespace Modbus
+{
+namespace R421A
+{
+namespace
+{
+// Command codes, sent in the upper byte of the register value
+enum r421a_command_t {
+	r421_close = 0x01,
+	r421_open = 0x02,
+	r421_toggle = 0x03,
+	r421_latch = 0x04,
+	r421_momentary = 0x05,
+	r421_delay = 0x06,
+	r421_close_all = 0x07,
+	r421_open_all = 0x08,
+};
+
+} // namespace
+
+bool VirtualSlave::handleRequest(PDU& pdu)
+{
+	switch(pdu.function()) {
+	case Function::ReadHoldingRegisters: {
+		auto req = pdu.data.readHoldingRegisters.request;
+		auto& rsp = pdu.data.readHoldingRegisters.response;
+		if(req.quantityOfRegisters == 0 || req.quantityOfRegisters > rsp.MaxRegisters) {
+			pdu.setException(Exception::IllegalDataValue);
+			return true;
+		}
+		rsp.setCount(req.quantityOfRegisters);
+		for(unsigned i = 0; i < req.quantityOfRegisters; ++i) {
+			auto ch = req.startAddress + i;
+			rsp.values[i] = isValid(ch) && states[ch];
+		}
+		return true;
+	}
+
+	case Function::WriteSingleRegister: {
+		// Response echoes the request
+		auto& req = pdu.data.writeSingleRegister.request;
+		auto ch = req.address;
+		auto cmd = req.value >> 8;
+		if(cmd == r421_close_all || cmd == r421_open_all) {
+			for(ch = R421_CHANNEL_MIN; isValid(ch); ++ch) {
+				states[ch] = (cmd == r421_close_all);
+			}
+			return true;
+		}
+		if(!isValid(ch)) {
+			return false;
+		}
+		switch(cmd) {
+		case r421_close:
+			states[ch] = true;
+			break;
+		case r421_open:
+			states[ch] = false;
+			break;
+		case r421_toggle:
+			states[ch] = !states[ch];
+			break;
+		case r421_latch:
+			for(unsigned i = R421_CHANNEL_MIN; isValid(i); ++i) {
+				states[i] = (i == ch);
+			}
+			break;
+		case r421_momentary:
+		case r421_delay:
+			break;
+		default:
+			return false;
+		}
+		return true;
+	}
+
+	default:
+		pdu.setException(Exception::IllegalFunction);
+		return true;
+	}
+}
+
+} // namespace R421A
+} // namespace Modbus
+} // namespace IO
@@ -0,0 +1,284 @@
+/**
+ * Device.cpp
+ *
+ * Copyright 2022 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the IOControl Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#include <IO/Modbus/RegisterMap/Device.h>
+#include <IO/Modbus/RegisterMap/Request.h>
+#include <IO/Strings.h>
+#include <FlashString/Vector.hpp>
+#include <algorithm>
+
+namespace IO
+{
+namespace Modbus
+{
+namespace RegisterMap
+{
+namespace
+{
+#define XX(tag, comment) DEFINE_FSTR(tablestr_##tag, #tag)
+IOREGMAP_TABLE_MAP(XX)
+#undef XX
+
+#define XX(tag, comment) &tablestr_##tag,
+DEFINE_FSTR_VECTOR(tableStrings, FSTR::String, IOREGMAP_TABLE_MAP(XX))
+#undef XX
+
+#define XX(tag, size) DEFINE_FSTR(typestr_##tag, #tag)
+IOREGMAP_TYPE_MAP(XX)
+#undef XX
+
+#define XX(tag, size) &typestr_##tag,
+DEFINE_FSTR_VECTOR(typeStrings, FSTR::String, IOREGMAP_TYPE_MAP(XX))
+#undef XX
+
+/*
+ * Largest block which can be read in one transaction
+ */
+uint16_t maxBlockSize(Table table)
+{
+	switch(table) {
+	case Table::coil:
+		return PDU::Data::ReadCoils::Response::MaxCoils;
+	case Table::discrete:
+		return PDU::Data::ReadDiscreteInputs::Response::MaxInputs;
+	case Table::input:
+		return PDU::Data::ReadInputRegisters::Response::MaxRegisters;
+	case Table::holding:
+	default:
+		return PDU::Data::ReadHoldingRegisters::Response::MaxRegisters;
+	}
+}
+
+} // namespace
+
+String toString(Table table)
+{
+	return tableStrings[unsigned(table)];
+}
+
+bool fromString(Table& table, const char* str)
+{
+	auto i = tableStrings.indexOf(str);
+	if(i < 0) {
+		debug_w("Unknown register table '%s'", str);
+		return false;
+	}
+
+	table = Table(i);
+	return true;
+}
+
+String toString(Type type)
+{
+	return typeStrings[unsigned(type)];
+}
+
+bool fromString(Type& type, const char* str)
+{
+	auto i = typeStrings.indexOf(str);
+	if(i < 0) {
+		debug_w("Unknown register type '%s'", str);
+		return false;
+	}
+
+	type = Type(i);
+	return true;
+}
+
+uint8_t Point::size() const
+{
+	if(isBit()) {
+		return 1;
+	}
+
+	switch(type) {
+#define XX(tag, size)                                                                                                  \
+	case Type::tag:                                                                                                    \
+		return size;
+		IOREGMAP_TYPE_MAP(XX)
+#undef XX
+	}
+
+	return 1;
+}
+
+const Device::Factory Device::factory;
+
+ErrorCode Device::init(const Config& config)
+{
+	auto err = Modbus::Device::init(config.modbus);
+	if(err) {
+		return err;
+	}
+
+	if(config.pointCount == 0 || config.pointCount > MAX_POINTS) {
+		return Error::bad_config;
+	}
+
+	points.reset(new Point[config.pointCount]);
+	values.reset(new float[config.pointCount]{});
+	blocks.reset(new Block[config.pointCount]);
+	if(!points || !values || !blocks) {
+		return Error::no_mem;
+	}
+
+	pointCount = config.pointCount;
+	std::copy_n(config.points, pointCount, points.get());
+	validMask = 0;
+	planBlocks(config.gap);
+
+	debug_d("Device %s has %u points in %u blocks", getId().c_str(), pointCount, blockCount);
+
+	return Error::success;
+}
+
+void Device::parseJson(JsonObjectConst json, Config& cfg)
+{
+	Modbus::Device::parseJson(json, cfg.modbus);
+	cfg.gap = json[FS_gap] | DEFAULT_GAP;
+}
+
+ErrorCode Device::init(JsonObjectConst json)
+{
+	Config cfg{};
+	parseJson(json, cfg);
+
+	JsonArrayConst arr = json[FS_points];
+	if(arr.size() > MAX_POINTS) {
+		return Error::bad_config;
+	}
+
+	std::unique_ptr<Point[]> pts(new Point[arr.size()]);
+	if(!pts) {
+		return Error::no_mem;
+	}
+	unsigned i{0};
+	for(JsonObjectConst obj : arr) {
+		auto& pt = pts[i++];
+		pt.name = obj[FS_name].as<const char*>();
+		pt.address = obj[FS_address];
+		pt.scale = obj[FS_scale] | 1.0f;
+		pt.offset = obj[FS_offset] | 0.0f;
+		const char* s;
+		if(Json::getValue(obj[FS_table], s) && !fromString(pt.table, s)) {
+			return Error::bad_config;
+		}
+		if(Json::getValue(obj[FS_type], s) && !fromString(pt.type, s)) {
+			return Error::bad_config;
+		}
+	}
+
+	cfg.points = pts.get();
+	cfg.pointCount = arr.size();
+	return init(cfg);
+}
+
+/*
+ * Group points into blocks for reading.
+ *
+ * Points are considered in table/address order. A point joins the current block if it's in the same table,
+ * starts no more than `gap` registers after the end of the block, and the block wouldn't exceed
+ * the maximum size for one transaction. Reading a few unused registers is cheaper than another transaction.
+ */
+void Device::planBlocks(uint16_t gap)
+{
+	uint8_t order[MAX_POINTS];
+	for(unsigned i = 0; i < pointCount; ++i) {
+		order[i] = i;
+	}
+	std::sort(order, order + pointCount, [this](uint8_t a, uint8_t b) {
+		auto& pa = points[a];
+		auto& pb = points[b];
+		return (pa.table != pb.table) ? pa.table < pb.table : pa.address < pb.address;
+	});
+
+	blockCount = 0;
+	Block* block{nullptr};
+	for(unsigned i = 0; i < pointCount; ++i) {
+		auto index = order[i];
+		auto& pt = points[index];
+		unsigned end = pt.address + pt.size();
+		if(block != nullptr && pt.table == block->table && pt.address <= block->address + block->count + gap &&
+		   end - block->address <= maxBlockSize(pt.table)) {
+			block->count = std::max(unsigned(block->count), end - block->address);
+		} else {
+			block = &blocks[blockCount++];
+			*block = Block{0, pt.address, uint16_t(pt.size()), pt.table};
+		}
+		block->points |= PointMask(1) << index;
+	}
+}
+
+PointMask Device::getBlockMask(PointMask pointMask) const
+{
+	PointMask mask{0};
+	for(unsigned i = 0; i < blockCount; ++i) {
+		if(blocks[i].points & pointMask) {
+			mask |= PointMask(1) << i;
+		}
+	}
+	return mask;
+}
+
+int Device::findPoint(const char* name) const
+{
+	for(unsigned i = 0; i < pointCount; ++i) {
+		if(points[i].name == name) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+IO::Request* Device::createRequest()
+{
+	return new Request(*this);
+}
+
+RequestPool* Device::getRequestPool() const
+{
+	return &Request::pool;
+}
+
+RequestPool* Device::Factory::getRequestPool() const
+{
+	return &Request::pool;
+}
+
+DevNode::States Device::getNodeStates(DevNode node) const
+{
+	if(node == DevNode_ALL) {
+		DevNode::States res;
+		for(unsigned i = 0; i < pointCount; ++i) {
+			res += getNodeStates(DevNode{DevNode::ID(i)});
+		}
+		return res;
+	}
+
+	float value;
+	if(!getValue(node.id, value)) {
+		return DevNode::State::unknown;
+	}
+
+	return (value != 0) ? DevNode::State::on : DevNode::State::off;
+}
+
+} // namespace RegisterMap
+} // namespace Modbus
+} // namespace IO
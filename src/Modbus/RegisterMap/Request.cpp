@@ -0,0 +1,362 @@
+/**
+ * Request.cpp
+ *
+ * Copyright 2022 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the IOControl Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#include <IO/Modbus/RegisterMap/Request.h>
+#include <IO/Strings.h>
+#include <cmath>
+#include <limits>
+
+namespace IO
+{
+namespace Modbus
+{
+namespace RegisterMap
+{
+namespace
+{
+/*
+ * Limits are converted exactly in double, whereas float rounds some up beyond the range of T
+ */
+template <typename T> T toInt(float value)
+{
+	if(std::isnan(value)) {
+		return 0;
+	}
+	double d = std::round(double(value));
+	d = std::max(d, double(std::numeric_limits<T>::min()));
+	d = std::min(d, double(std::numeric_limits<T>::max()));
+	return T(d);
+}
+
+uint8_t lowestBit(PointMask mask)
+{
+	return __builtin_ctzll(mask);
+}
+
+} // namespace
+
+RequestPool Request::pool{sizeof(Request)};
+
+ErrorCode Request::parseJson(JsonObjectConst json)
+{
+	auto err = Modbus::Request::parseJson(json);
+	if(!err) {
+		Json::getValue(json[FS_value], value);
+	}
+
+	return err;
+}
+
+void Request::getJson(JsonObject json) const
+{
+	Modbus::Request::getJson(json);
+
+	auto& dev = getDevice();
+	JsonObject obj = json.createNestedObject(FS_values);
+	for(unsigned i = 0; i < dev.getPointCount(); ++i) {
+		float value;
+		if((response & (PointMask(1) << i)) == 0 || !dev.getValue(i, value)) {
+			continue;
+		}
+		auto& name = dev.getPoint(i).name;
+		if(name) {
+			obj[name.c_str()] = value;
+		} else {
+			obj[String(i)] = value;
+		}
+	}
+}
+
+bool Request::setNode(DevNode node)
+{
+	auto& dev = getDevice();
+	if(node == DevNode_ALL) {
+		auto count = dev.getPointCount();
+		nodeMask = (count >= MAX_POINTS) ? ~PointMask(0) : (PointMask(1) << count) - 1;
+		return true;
+	}
+
+	if(!dev.isValid(node)) {
+		return false;
+	}
+
+	nodeMask |= PointMask(1) << node.id;
+	return true;
+}
+
+DevNode::States Request::getNodeStates(DevNode node)
+{
+	DevNode::States states;
+	if(node == DevNode_ALL) {
+		auto mask = isPending() ? nodeMask : response;
+		for(unsigned i = 0; i < getDevice().getPointCount(); ++i) {
+			if(mask & (PointMask(1) << i)) {
+				states += getDevice().getNodeStates(DevNode{DevNode::ID(i)});
+			}
+		}
+	} else {
+		states = getDevice().getNodeStates(node);
+	}
+
+	return states;
+}
+
+/*
+ * Queries read a superset of, or the same points as, any query they duplicate.
+ * A write replaces any queued write to a subset of its points.
+ */
+IO::Request::Merge Request::checkMerge(const IO::Request& other) const
+{
+	if(&other.device != &device) {
+		return Merge::none;
+	}
+
+	auto cmd = getCommand();
+	auto otherCmd = other.getCommand();
+	if(cmd == Command::query) {
+		if(otherCmd != Command::query) {
+			return Merge::none;
+		}
+	} else if(!isWrite() || (otherCmd != Command::set && otherCmd != Command::on && otherCmd != Command::off)) {
+		return Merge::none;
+	}
+
+	// Only requests of this class issue these commands
+	auto& req = static_cast<const Request&>(other);
+	if(isBroadcast() != req.isBroadcast()) {
+		return Merge::none;
+	}
+
+	if(cmd == Command::query) {
+		bool covered = (nodeMask & ~req.nodeMask) == 0;
+		return covered ? Merge::duplicate : Merge::none;
+	}
+
+	if(nodeMask == req.nodeMask && writeValue() == req.writeValue()) {
+		return Merge::duplicate;
+	}
+
+	if((req.nodeMask & ~nodeMask) == 0) {
+		return Merge::supersede;
+	}
+
+	return Merge::none;
+}
+
+void Request::copyResult(const IO::Request& other)
+{
+	response = static_cast<const Request&>(other).response & nodeMask;
+}
+
+/*
+ * Writes to a single register point can be cached, subject to the device configuration
+ */
+bool Request::canWriteBehind() const
+{
+	if(!isWrite() || nodeMask == 0 || (nodeMask & (nodeMask - 1)) != 0) {
+		return false;
+	}
+
+	auto& pt = getDevice().getPoint(lowestBit(nodeMask));
+	return pt.isWritable() && !pt.isBit();
+}
+
+/*
+ * A query reads each required block in turn, a write goes to each point in turn.
+ */
+Function Request::fillRequestData(PDU::Data& data)
+{
+	auto& dev = getDevice();
+
+	if(activeIndex < 0) {
+		if(isWrite()) {
+			for(unsigned i = 0; i < dev.getPointCount(); ++i) {
+				if(dev.getPoint(i).isWritable()) {
+					pending |= nodeMask & (PointMask(1) << i);
+				}
+			}
+		} else if(getCommand() == Command::query) {
+			pending = dev.getBlockMask(nodeMask);
+		}
+	}
+
+	if(pending == 0) {
+		debug_e("[REGMAP] Nothing to do");
+		return Function::None;
+	}
+
+	activeIndex = lowestBit(pending);
+
+	if(isWrite()) {
+		return fillWriteData(data);
+	}
+
+	auto& block = dev.getBlock(activeIndex);
+	auto& req = data.readHoldingRegisters.request; // All read requests have the same layout
+	req.startAddress = block.address;
+	req.quantityOfRegisters = block.count;
+	switch(block.table) {
+	case Table::coil:
+		return Function::ReadCoils;
+	case Table::discrete:
+		return Function::ReadDiscreteInputs;
+	case Table::input:
+		return Function::ReadInputRegisters;
+	case Table::holding:
+	default:
+		return Function::ReadHoldingRegisters;
+	}
+}
+
+Function Request::fillWriteData(PDU::Data& data)
+{
+	auto& pt = getDevice().getPoint(activeIndex);
+	auto value = writeValue();
+
+	if(pt.table == Table::coil) {
+		auto& req = data.writeSingleCoil.request;
+		req.outputAddress = pt.address;
+		req.outputValue = (value != 0) ? req.state_on : req.state_off;
+		return Function::WriteSingleCoil;
+	}
+
+	float raw = (value - pt.offset) / (pt.scale ?: 1);
+	uint32_t bits;
+	switch(pt.type) {
+	case Type::s16:
+		bits = uint16_t(toInt<int16_t>(raw));
+		break;
+	case Type::u32:
+		bits = toInt<uint32_t>(raw);
+		break;
+	case Type::s32:
+		bits = uint32_t(toInt<int32_t>(raw));
+		break;
+	case Type::f32:
+		memcpy(&bits, &raw, sizeof(bits));
+		break;
+	case Type::u16:
+	default:
+		bits = toInt<uint16_t>(raw);
+	}
+
+	if(pt.size() == 1) {
+		auto& req = data.writeSingleRegister.request;
+		req.address = pt.address;
+		req.value = bits;
+		return Function::WriteSingleRegister;
+	}
+
+	auto& req = data.writeMultipleRegisters.request;
+	req.startAddress = pt.address;
+	req.setCount(2);
+	req.values[0] = bits >> 16;
+	req.values[1] = bits;
+	return Function::WriteMultipleRegisters;
+}
+
+void Request::readBlock(const Block& block, const PDU& pdu)
+{
+	auto& dev = getDevice();
+	for(unsigned i = 0; i < dev.getPointCount(); ++i) {
+		auto bit = PointMask(1) << i;
+		if((block.points & bit) == 0) {
+			continue;
+		}
+
+		auto& pt = dev.getPoint(i);
+		unsigned offset = pt.address - block.address;
+		float raw;
+		if(pt.isBit()) {
+			// Coils and discrete inputs have the same layout
+			auto& rsp = pdu.data.readCoils.response;
+			if(offset >= rsp.getCount()) {
+				continue;
+			}
+			raw = (rsp.coilStatus[offset / 8] >> (offset % 8)) & 0x01;
+		} else {
+			// Holding and input registers have the same layout
+			auto& rsp = pdu.data.readHoldingRegisters.response;
+			if(offset + pt.size() > rsp.getCount()) {
+				continue;
+			}
+			uint16_t hi = rsp.values[offset];
+			uint32_t bits = (pt.size() > 1) ? (uint32_t(hi) << 16) | rsp.values[offset + 1] : hi;
+			switch(pt.type) {
+			case Type::s16:
+				raw = int16_t(bits);
+				break;
+			case Type::u32:
+				raw = bits;
+				break;
+			case Type::s32:
+				raw = int32_t(bits);
+				break;
+			case Type::f32:
+				memcpy(&raw, &bits, sizeof(raw));
+				break;
+			case Type::u16:
+			default:
+				raw = bits;
+			}
+		}
+
+		dev.setValue(i, raw * pt.scale + pt.offset);
+		response |= bit & nodeMask;
+	}
+}
+
+ErrorCode Request::callback(PDU& pdu)
+{
+	if(activeIndex < 0) {
+		return Error::bad_command;
+	}
+
+	switch(pdu.function()) {
+	case Function::ReadCoils:
+	case Function::ReadDiscreteInputs:
+	case Function::ReadHoldingRegisters:
+	case Function::ReadInputRegisters:
+		readBlock(getDevice().getBlock(activeIndex), pdu);
+		break;
+
+	case Function::WriteSingleCoil:
+	case Function::WriteSingleRegister:
+	case Function::WriteMultipleRegisters:
+		getDevice().setValue(activeIndex, writeValue());
+		response |= PointMask(1) << activeIndex;
+		break;
+
+	default:
+		return Error::bad_command;
+	}
+
+	// Re-submit request for next block or point, if any, otherwise we're done
+	pending &= ~(PointMask(1) << activeIndex);
+	if(pending != 0) {
+		submit();
+		return Error::pending;
+	}
+
+	return Error::success;
+}
+
+} // namespace RegisterMap
+} // namespace Modbus
+} // namespace IO
@@ -0,0 +1,114 @@
+/**
+ * Modbus/RegisterMap/VirtualSlave.cpp
+ *
+ * Copyright 2022 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the IOControl Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#include <IO/Modbus/RegisterMap/VirtualSlave.h>
+
+namespace IO
+{
+namespace Modbus
+{
+namespace RegisterMap
+{
+bool VirtualSlave::readBits(Table table, PDU& pdu)
+{
+	// Coils and discrete inputs have the same layout
+	auto req = pdu.data.readCoils.request;
+	auto& rsp = pdu.data.readCoils.response;
+	if(!isValid(req.startAddress, req.quantityOfCoils) || req.quantityOfCoils > rsp.MaxCoils) {
+		pdu.setException(Exception::IllegalDataAddress);
+		return true;
+	}
+	rsp.setCount(req.quantityOfCoils);
+	memset(rsp.coilStatus, 0, rsp.byteCount);
+	for(unsigned i = 0; i < req.quantityOfCoils; ++i) {
+		rsp.setCoil(i, getValue(table, req.startAddress + i));
+	}
+	return true;
+}
+
+bool VirtualSlave::readRegisters(Table table, PDU& pdu)
+{
+	// Holding and input registers have the same layout
+	auto req = pdu.data.readHoldingRegisters.request;
+	auto& rsp = pdu.data.readHoldingRegisters.response;
+	if(!isValid(req.startAddress, req.quantityOfRegisters) || req.quantityOfRegisters > rsp.MaxRegisters) {
+		pdu.setException(Exception::IllegalDataAddress);
+		return true;
+	}
+	rsp.setCount(req.quantityOfRegisters);
+	for(unsigned i = 0; i < req.quantityOfRegisters; ++i) {
+		rsp.values[i] = getValue(table, req.startAddress + i);
+	}
+	return true;
+}
+
+bool VirtualSlave::handleRequest(PDU& pdu)
+{
+	switch(pdu.function()) {
+	case Function::ReadCoils:
+		return readBits(Table::coil, pdu);
+
+	case Function::ReadDiscreteInputs:
+		return readBits(Table::discrete, pdu);
+
+	case Function::ReadHoldingRegisters:
+		return readRegisters(Table::holding, pdu);
+
+	case Function::ReadInputRegisters:
+		return readRegisters(Table::input, pdu);
+
+	// Responses to write requests echo the address and value or quantity
+	case Function::WriteSingleCoil: {
+		auto& req = pdu.data.writeSingleCoil.request;
+		if(!setValue(Table::coil, req.outputAddress, req.outputValue == req.state_on)) {
+			pdu.setException(Exception::IllegalDataAddress);
+		}
+		return true;
+	}
+
+	case Function::WriteSingleRegister: {
+		auto& req = pdu.data.writeSingleRegister.request;
+		if(!setValue(Table::holding, req.address, req.value)) {
+			pdu.setException(Exception::IllegalDataAddress);
+		}
+		return true;
+	}
+
+	case Function::WriteMultipleRegisters: {
+		auto& req = pdu.data.writeMultipleRegisters.request;
+		uint16_t count = req.quantityOfRegisters;
+		if(!isValid(req.startAddress, count) || count > req.MaxRegisters) {
+			pdu.setException(Exception::IllegalDataAddress);
+			return true;
+		}
+		for(unsigned i = 0; i < count; ++i) {
+			setValue(Table::holding, req.startAddress + i, req.values[i]);
+		}
+		return true;
+	}
+
+	default:
+		pdu.setException(Exception::IllegalFunction);
+		return true;
+	}
+}
+
+} // namespace RegisterMap
+} // namespace Modbus
+} // namespace IO
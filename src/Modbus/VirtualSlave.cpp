@@ -0,0 +1,50 @@
+/**
+ * Modbus/VirtualSlave.cpp
+ *
+ * Copyright 2022 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the IOControl Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#include <IO/Modbus/VirtualSlave.h>
+
+namespace IO
+{
+namespace Modbus
+{
+size_t VirtualSlave::receive(const uint8_t* data, size_t size, uint8_t* response)
+{
+	if(size < ADU::MinSize || size > ADU::MaxSize || (data[0] != address && data[0] != ADU::BROADCAST_ADDRESS)) {
+		return 0;
+	}
+
+	ADU adu;
+	memcpy(adu.buffer, data, size);
+	if(adu.parseRequest(size)) {
+		++stats.errors;
+		return 0;
+	}
+
+	++stats.requests;
+	if(!handleRequest(adu.pdu) || adu.slaveAddress == ADU::BROADCAST_ADDRESS) {
+		return 0;
+	}
+
+	auto responseSize = adu.prepareResponse();
+	memcpy(response, adu.buffer, responseSize);
+	return responseSize;
+}
+
+} // namespace Modbus
+} // namespace IO
@@ -0,0 +1,325 @@
+/**
+ * Modbus/WriteCache.cpp
+ *
+ * Copyright 2022 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the IOControl Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#include <IO/Modbus/WriteCache.h>
+#include <IO/Modbus/Request.h>
+
+namespace IO
+{
+namespace Modbus
+{
+namespace
+{
+/*
+ * Get the registers written by a request
+ */
+bool getRegisters(Function function, const PDU::Data& data, uint16_t& address, uint16_t& count)
+{
+	switch(function) {
+	case Function::WriteSingleRegister:
+		address = data.writeSingleRegister.request.address;
+		count = 1;
+		return true;
+	case Function::WriteMultipleRegisters:
+		address = data.writeMultipleRegisters.request.startAddress;
+		count = data.writeMultipleRegisters.request.quantityOfRegisters;
+		return count != 0;
+	default:
+		return false;
+	}
+}
+
+} // namespace
+
+/**
+ * @brief Writes the dirty registers, then completes the requests which were merged into it
+ */
+class WriteCache::FlushRequest : public Request
+{
+public:
+	FlushRequest(Device& device) : Request(device)
+	{
+		setPriority(Priority::background);
+	}
+
+	/**
+	 * @brief Add register values from a write, replacing any existing value (last writer wins)
+	 */
+	void addWrite(Function function, const PDU::Data& data);
+
+	unsigned getEntryCount() const
+	{
+		return entryCount;
+	}
+
+	unsigned getWaiterCount()
+	{
+		return getMerged().count();
+	}
+
+	Function fillRequestData(PDU::Data& data) override;
+	ErrorCode callback(PDU& pdu) override;
+	void handleEvent(Event event) override;
+
+private:
+	struct Entry {
+		uint16_t address;
+		uint16_t value;
+	};
+
+	void addEntry(uint16_t address, uint16_t value);
+	void completeWaiters();
+
+	Entry entries[MAX_REGISTERS]; ///< Sorted by address
+	uint8_t entryCount{0};
+	uint8_t index{0};	 ///< First entry for current transaction
+	uint8_t runLength{0}; ///< Number of entries in current transaction
+	bool prepared{false}; ///< Entries rebuilt from the surviving requests
+};
+
+void WriteCache::FlushRequest::addWrite(Function function, const PDU::Data& data)
+{
+	uint16_t address;
+	uint16_t count;
+	if(!getRegisters(function, data, address, count)) {
+		return;
+	}
+
+	if(function == Function::WriteSingleRegister) {
+		addEntry(address, data.writeSingleRegister.request.value);
+		return;
+	}
+
+	for(unsigned i = 0; i < count; ++i) {
+		addEntry(address + i, data.writeMultipleRegisters.request.values[i]);
+	}
+}
+
+/*
+ * Insert in address order
+ */
+void WriteCache::FlushRequest::addEntry(uint16_t address, uint16_t value)
+{
+	unsigned i = 0;
+	while(i < entryCount && entries[i].address < address) {
+		++i;
+	}
+
+	if(i < entryCount && entries[i].address == address) {
+		entries[i].value = value;
+		return;
+	}
+
+	if(entryCount == MAX_REGISTERS) {
+		return;
+	}
+
+	memmove(&entries[i + 1], &entries[i], (entryCount - i) * sizeof(Entry));
+	entries[i] = Entry{address, value};
+	++entryCount;
+}
+
+/*
+ * Write the next run of contiguous registers
+ */
+Function WriteCache::FlushRequest::fillRequestData(PDU::Data& data)
+{
+	auto run = &entries[index];
+	unsigned count = entryCount - index;
+	runLength = 1;
+	while(runLength < count && runLength < PDU::Data::WriteMultipleRegisters::Request::MaxRegisters &&
+		  run[runLength].address == run[runLength - 1].address + 1) {
+		++runLength;
+	}
+
+	if(runLength == 1) {
+		auto& req = data.writeSingleRegister.request;
+		req.address = run[0].address;
+		req.value = run[0].value;
+		return Function::WriteSingleRegister;
+	}
+
+	auto& req = data.writeMultipleRegisters.request;
+	req.startAddress = run[0].address;
+	req.setCount(runLength);
+	for(unsigned i = 0; i < runLength; ++i) {
+		req.values[i] = run[i].value;
+	}
+	return Function::WriteMultipleRegisters;
+}
+
+ErrorCode WriteCache::FlushRequest::callback(PDU& pdu)
+{
+	index += runLength;
+	if(index < entryCount) {
+		submit();
+		return Error::pending;
+	}
+
+	return Error::success;
+}
+
+void WriteCache::FlushRequest::handleEvent(Event event)
+{
+	switch(event) {
+	case Event::Execute:
+		if(prepared) {
+			break;
+		}
+		/*
+		 * The controller has already completed any requests which expired whilst waiting,
+		 * and cancelled requests are gone, so write only what's left.
+		 */
+		prepared = true;
+		entryCount = 0;
+		for(auto& req : getMerged()) {
+			PDU::Data data;
+			auto function = static_cast<Request&>(req).fillRequestData(data);
+			addWrite(function, data);
+		}
+		if(entryCount == 0) {
+			complete(Error::success);
+			return;
+		}
+		break;
+
+	case Event::RequestComplete:
+		completeWaiters();
+		break;
+
+	default:
+		break;
+	}
+
+	Request::handleEvent(event);
+}
+
+/*
+ * Pass each absorbed request the response its own write would have received.
+ * A request with more to do is submitted again.
+ */
+void WriteCache::FlushRequest::completeWaiters()
+{
+	IO::Request* waiter;
+	while((waiter = getMerged().pop()) != nullptr) {
+		auto req = static_cast<Request*>(waiter);
+		auto err = error();
+		if(!err) {
+			PDU::Data data;
+			PDU pdu{};
+			pdu.setFunction(req->fillRequestData(data));
+			// Echo response is the start of the request data
+			memcpy(&pdu.data, &data, 4);
+			err = req->callback(pdu);
+			if(err == Error::pending) {
+				req->submit();
+				continue;
+			}
+		}
+		req->complete(err);
+	}
+}
+
+WriteCache::WriteCache(Device& device, uint16_t window) : device(device), window(window)
+{
+	timer.initializeMs(
+		window, [](void* arg) { static_cast<WriteCache*>(arg)->flush(); }, this);
+}
+
+/*
+ * Absorbed requests must still complete, but the writes are discarded
+ */
+WriteCache::~WriteCache()
+{
+	timer.stop();
+	auto req = pending;
+	pending = nullptr;
+	if(req != nullptr) {
+		req->cancel();
+	}
+}
+
+unsigned WriteCache::getDirtyCount() const
+{
+	return pending ? pending->getEntryCount() : 0;
+}
+
+bool WriteCache::submit(Request& request)
+{
+	// Don't hold a write beyond its deadline
+	auto deadline = request.getDeadline();
+	if(!request.canWriteBehind() || request.isBroadcast() || (deadline != 0 && deadline <= window)) {
+		flush(request.getPriority());
+		return false;
+	}
+
+	PDU::Data data;
+	auto function = request.fillRequestData(data);
+	uint16_t address;
+	uint16_t count;
+	if(!getRegisters(function, data, address, count) || count > MAX_REGISTERS) {
+		flush(request.getPriority());
+		return false;
+	}
+
+	// Make room
+	if(pending != nullptr &&
+	   (pending->getWaiterCount() == MAX_WAITERS || pending->getEntryCount() + count > MAX_REGISTERS)) {
+		flush(request.getPriority());
+	}
+
+	if(pending == nullptr) {
+		pending = new FlushRequest(device);
+		if(pending == nullptr) {
+			debug_e("[MB] Write-behind failed, no memory");
+			return false;
+		}
+	}
+
+	pending->addWrite(function, data);
+	pending->setPriority(std::max(pending->getPriority(), request.getPriority()));
+	device.holdRequest(*pending, request);
+
+	debug_d("[MB] Write-behind %u registers @ %u, %u dirty", count, address, pending->getEntryCount());
+
+	if(!timer.isStarted()) {
+		timer.startOnce();
+	}
+
+	return true;
+}
+
+void WriteCache::flush(Priority priority)
+{
+	timer.stop();
+
+	auto req = pending;
+	if(req == nullptr) {
+		return;
+	}
+
+	// Requests completing during submission may write again
+	pending = nullptr;
+	req->setPriority(std::max(req->getPriority(), priority));
+	debug_d("[MB] Flushing %u registers", req->getEntryCount());
+	device.releaseRequest(*req);
+}
+
+} // namespace Modbus
+} // namespace IO
@@ -0,0 +1,136 @@
+/**
+ * NodeMonitor.cpp
+ *
+ * Copyright 2022 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the IOControl Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#include <IO/NodeMonitor.h>
+#include <IO/Device.h>
+#include <Platform/System.h>
+
+namespace IO
+{
+uint16_t NodeMonitor::subscribe(const Device* device, DevNode node, Callback callback)
+{
+	auto sub = new Subscription;
+	if(sub == nullptr) {
+		return 0;
+	}
+
+	sub->callback = callback;
+	if(device != nullptr) {
+		sub->deviceId = device->getId();
+	}
+	sub->node = node;
+	return subscriptions.add(sub);
+}
+
+bool NodeMonitor::unsubscribe(uint16_t id)
+{
+	return subscriptions.remove(id);
+}
+
+bool NodeMonitor::Subscription::matches(const Device& device) const
+{
+	return !deviceId || deviceId == device.getId().c_str();
+}
+
+void NodeMonitor::deviceUpdated(Device& device)
+{
+	if(device.maxNodes() == 0) {
+		return;
+	}
+
+	if(!subscriptions.any([&](const Subscription& sub) { return sub.matches(device); })) {
+		return;
+	}
+
+	DeviceStates* states{nullptr};
+	for(auto& ds : devices) {
+		if(&ds.device == &device) {
+			states = &ds;
+			break;
+		}
+	}
+	if(states == nullptr) {
+		states = new DeviceStates(device);
+		if(states == nullptr) {
+			return;
+		}
+		devices.add(states);
+	}
+
+	states->changed = true;
+	if(!scheduled) {
+		scheduled = System.queueCallback(notifyStatic, this);
+	}
+}
+
+void NodeMonitor::DeviceStates::getChanges(NodeChangeList& changes)
+{
+	changed = false;
+
+	auto idMin = device.nodeIdMin();
+	unsigned nodeCount = device.nodeIdMax() + 1 - idMin;
+	if(!states || count != nodeCount) {
+		states.reset(new DevNode::State[nodeCount]);
+		if(!states) {
+			count = 0;
+			return;
+		}
+		count = nodeCount;
+		std::fill_n(states.get(), count, DevNode::State::unknown);
+	}
+
+	for(unsigned i = 0; i < count; ++i) {
+		DevNode node{DevNode::ID(idMin + i)};
+		auto state = getState(device.getNodeStates(node));
+		if(state != states[i]) {
+			states[i] = state;
+			changes.add(NodeChange{&device, node, state});
+		}
+	}
+}
+
+void NodeMonitor::notify()
+{
+	scheduled = false;
+
+	NodeChangeList changes;
+	for(auto& ds : devices) {
+		if(ds.changed) {
+			ds.getChanges(changes);
+		}
+	}
+	if(changes.isEmpty()) {
+		return;
+	}
+
+	NodeChangeList list;
+	subscriptions.dispatch([&](Subscription& sub) {
+		list.clear();
+		for(auto& change : changes) {
+			if(sub.matches(change)) {
+				list.add(change);
+			}
+		}
+		if(!list.isEmpty() && sub.callback) {
+			sub.callback(list);
+		}
+	});
+}
+
+} // namespace IO
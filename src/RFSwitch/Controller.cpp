@@ -88,8 +88,11 @@ void Controller::handleEvent(IO::Request* request, Event event)
 		break;
 
 	case Event::RequestComplete:
-		activeRequest = nullptr;
-		transmitState = idle;
+		// Requests may complete without being executed
+		if(request == activeRequest) {
+			activeRequest = nullptr;
+			transmitState = idle;
+		}
 		break;
 
 	case Event::Timeout:
@@ -76,5 +76,15 @@ IO::Request* Device::createRequest()
 	return new Request(*this);
 }
 
+RequestPool* Device::getRequestPool() const
+{
+	return &Request::pool;
+}
+
+RequestPool* Device::Factory::getRequestPool() const
+{
+	return &Request::pool;
+}
+
 } // namespace RFSwitch
 } // namespace IO
@@ -25,6 +25,8 @@ namespace IO
 {
 namespace RFSwitch
 {
+RequestPool Request::pool{sizeof(Request)};
+
 void Request::send(uint32_t code, uint8_t repeats)
 {
 	this->code = code;
@@ -18,9 +18,11 @@
  ****/
 
 #include <IO/RS485/Controller.h>
+#include <IO/RS485/Device.h>
 #include <IO/Request.h>
 #include "Platform/System.h"
 #include <driver/uart.h>
+#include <IO/Clock.h>
 
 // ESP32 has a TX_DONE interrupt, others do not
 #ifdef ARCH_ESP32
@@ -34,11 +36,9 @@ namespace RS485
 // Device configuration
 DEFINE_FSTR(CONTROLLER_CLASSNAME, "rs485")
 
-constexpr unsigned TRANSACTION_TIMEOUT_MS = 800;
-
 void Controller::start()
 {
-	serial.setCallback(uartCallbackStatic, this);
+	serial.setCallback(serialCallback, this);
 	request = nullptr;
 	IO::Controller::start();
 }
@@ -52,9 +52,23 @@ void Controller::stop()
 	serial.setCallback(nullptr, nullptr);
 }
 
-void Controller::uartCallbackStatic(smg_uart_t* uart, uint32_t status)
+void Controller::freeDevices()
+{
+	IO::Controller::freeDevices();
+	dmxUniverse.reset();
+}
+
+DMX512::Universe* Controller::getDmxUniverse()
+{
+	if(!dmxUniverse) {
+		dmxUniverse.reset(new DMX512::Universe);
+	}
+	return dmxUniverse.get();
+}
+
+void Controller::serialCallback(void* param, uint32_t status)
 {
-	auto controller = static_cast<Controller*>(smg_uart_get_callback_param(uart));
+	auto controller = static_cast<Controller*>(param);
 	// Guard against spurious interrupts
 	if(controller != nullptr) {
 		controller->uartCallback(status);
@@ -70,6 +84,7 @@ void Controller::uartCallback(uint32_t status)
 #endif
 		setDirection(Direction::Incoming);
 		serial.clear(UART_RX_ONLY);
+		lastActivity = Clock::micros();
 		status = 0;
 		// Guard against timeout firing before this callback
 		if(request != nullptr && transmitCompleteRequest == nullptr) {
@@ -85,8 +100,21 @@ void Controller::uartCallback(uint32_t status)
 		}
 	}
 
-	// Rx FIFO full or timeout
-	if(status & (UART_STATUS_RXFIFO_FULL | UART_STATUS_RXFIFO_TOUT)) {
+	/*
+	 * Complete on timeout, or as soon as the expected response has arrived.
+	 * The driver only reports RXFIFO_FULL once its buffer is full, so check what's been received on every callback.
+	 */
+	bool rxComplete;
+	if(status & UART_STATUS_RXFIFO_TOUT) {
+		rxComplete = true;
+	} else if(expectedSize != 0) {
+		rxComplete = serial.available() >= expectedSize;
+	} else {
+		rxComplete = status & UART_STATUS_RXFIFO_FULL;
+	}
+	// Ignore stray input whilst a request waits for the inter-frame gap, it is cleared before sending
+	if(rxComplete && deferredRequest == nullptr) {
+		lastActivity = Clock::micros();
 		timer.stop();
 		setDirection(Direction::Idle);
 		System.queueCallback(
@@ -101,11 +129,12 @@ void Controller::uartCallback(uint32_t status)
 void Controller::handleEvent(Request* request, Event event)
 {
 	switch(event) {
-	case Event::Execute:
+	case Event::Execute: {
 		this->request = request;
 		transmitCompleteRequest = nullptr;
 		// Put a timeout on the overall transaction
-		timer.initializeMs<TRANSACTION_TIMEOUT_MS>(
+		auto& dev = static_cast<Device&>(request->device);
+		timer.initializeMs(dev.timeout(),
 			[](void* param) {
 				auto ctrl = static_cast<Controller*>(param);
 				ctrl->transmitCompleteRequest = nullptr;
@@ -113,14 +142,28 @@ void Controller::handleEvent(Request* request, Event event)
 			},
 			this);
 		timer.startOnce();
-		savedConfig = serial.getConfig();
+		if(!configSaved) {
+			savedConfig = serial.getConfig();
+			configSaved = true;
+		}
 		break;
+	}
 
 	case Event::RequestComplete:
-		timer.stop();
-		setDirection(Direction::Idle);
-		this->request = nullptr;
-		serial.setConfig(savedConfig);
+		// Requests may complete without being executed
+		if(request == this->request) {
+			timer.stop();
+			setDirection(Direction::Idle);
+			expectResponse(0);
+			this->request = nullptr;
+			IO::Controller::handleEvent(request, event);
+			// Consecutive requests with the same settings don't need reconfiguring in between
+			if(this->request == nullptr && configSaved) {
+				setConfig(savedConfig);
+				configSaved = false;
+			}
+			return;
+		}
 		break;
 
 	case Event::Timeout: {
@@ -141,6 +184,12 @@ void Controller::handleEvent(Request* request, Event event)
 	IO::Controller::handleEvent(request, event);
 }
 
+bool Controller::isSameLink(const Request& request) const
+{
+	auto& dev = static_cast<const Device&>(request.device);
+	return dev.segment() == segment && dev.getSerialConfig() == serial.getConfig();
+}
+
 void Controller::receiveComplete()
 {
 	transmitCompleteRequest = nullptr;
@@ -151,6 +200,38 @@ void Controller::receiveComplete()
 	}
 }
 
+void Controller::expectResponse(size_t size)
+{
+	expectedSize = size;
+	serial.setRxFullThreshold(std::min(size, size_t(0xff)));
+}
+
+/*
+ * A new frame must be preceded by an idle interval of at least t3.5.
+ * If the previous response completed early (see expectResponse) this may not have elapsed yet,
+ * so hold the request on the timer until it has.
+ */
+void Controller::startExecution(Request& request)
+{
+	uint32_t elapsed = Clock::micros() - lastActivity;
+	auto frameGap = serial.getTiming().frameGap;
+	if(elapsed >= frameGap) {
+		IO::Controller::startExecution(request);
+		return;
+	}
+
+	deferredRequest = &request;
+	timer.initializeUs(frameGap - elapsed,
+		[](void* param) {
+			auto ctrl = static_cast<Controller*>(param);
+			auto req = ctrl->deferredRequest;
+			ctrl->deferredRequest = nullptr;
+			ctrl->IO::Controller::startExecution(*req);
+		},
+		this);
+	timer.startOnce();
+}
+
 void Controller::send(const void* data, size_t size)
 {
 	setDirection(Direction::Outgoing);
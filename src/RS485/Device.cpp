@@ -22,6 +22,7 @@
 #include <IO/RS485/Device.h>
 #include <IO/Request.h>
 #include <IO/Strings.h>
+#include <IO/Clock.h>
 
 namespace IO
 {
@@ -43,6 +44,7 @@ ErrorCode Device::init(const Config& config)
 	}
 
 	slaveConfig = config.slave;
+	rtt.reset();
 
 	return Error::success;
 }
@@ -60,6 +62,8 @@ void Device::parseJson(JsonObjectConst json, Config& cfg)
 	cfg.slave.segment = json[FS_segment];
 	cfg.slave.address = json[FS_address];
 	cfg.slave.baudrate = json[FS_baudrate];
+	cfg.slave.timeout = json[FS_timeout];
+	cfg.slave.adaptive = json[FS_adaptive];
 }
 
 void Device::handleEvent(IO::Request* request, Event event)
@@ -69,12 +73,19 @@ void Device::handleEvent(IO::Request* request, Event event)
 	switch(event) {
 	case Event::Execute: {
 		getController().setSegment(dev.segment());
+		executeTime = Clock::millis();
 		break;
 	}
 
-	case Event::TransmitComplete:
-	case Event::Timeout:
 	case Event::ReceiveComplete:
+		rtt.update(Clock::millis() - executeTime);
+		break;
+
+	case Event::Timeout:
+		rtt.timedOut();
+		break;
+
+	case Event::TransmitComplete:
 	case Event::RequestComplete:
 		break;
 	}
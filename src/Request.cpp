@@ -21,6 +21,7 @@
 #include <IO/Device.h>
 #include <IO/Strings.h>
 #include <FlashString/Vector.hpp>
+#include <IO/Clock.h>
 
 namespace IO
 {
@@ -32,6 +33,14 @@ IOCOMMAND_MAP(XX)
 DEFINE_FSTR_VECTOR(commandStrings, FSTR::String, IOCOMMAND_MAP(XX))
 #undef XX
 
+#define XX(tag, comment) DEFINE_FSTR(prstr_##tag, #tag)
+IOPRIORITY_MAP(XX)
+#undef XX
+
+#define XX(tag, comment) &prstr_##tag,
+DEFINE_FSTR_VECTOR(priorityStrings, FSTR::String, IOPRIORITY_MAP(XX))
+#undef XX
+
 String toString(Command cmd)
 {
 	return commandStrings[unsigned(cmd)];
@@ -49,6 +58,23 @@ bool fromString(Command& cmd, const char* str)
 	return true;
 }
 
+String toString(Priority priority)
+{
+	return priorityStrings[unsigned(priority)];
+}
+
+bool fromString(Priority& priority, const char* str)
+{
+	auto i = priorityStrings.indexOf(str);
+	if(i < 0) {
+		debug_w("Unknown IO priority '%s'", str);
+		return false;
+	}
+
+	priority = Priority(i);
+	return true;
+}
+
 ErrorCode Request::parseJson(JsonObjectConst json)
 {
 	const char* id;
@@ -62,6 +88,15 @@ ErrorCode Request::parseJson(JsonObjectConst json)
 		return Error::bad_command;
 	}
 
+	// Priority is optional
+	const char* pri;
+	if(Json::getValue(json[FS_priority], pri) && !fromString(priority, pri)) {
+		return Error::bad_param;
+	}
+
+	// Deadline is optional
+	Json::getValue(json[FS_deadline], deadline);
+
 	DevNode node;
 	JsonArrayConst arr;
 	if(Json::getValue(json[FS_node], node.id)) {
@@ -102,8 +137,30 @@ void Request::submit()
 	device.submit(this);
 }
 
+bool Request::cancel()
+{
+	return device.cancel(this);
+}
+
 void Request::handleEvent(Event event)
 {
+	switch(event) {
+	case Event::Execute:
+		if(timing.execute == 0) {
+			timing.execute = Clock::micros();
+		}
+		break;
+	case Event::TransmitComplete:
+		timing.transmit = Clock::micros();
+		break;
+	case Event::ReceiveComplete:
+		timing.receive = Clock::micros();
+		break;
+	case Event::RequestComplete:
+	case Event::Timeout:
+		break;
+	}
+
 	device.handleEvent(this, event);
 }
 
@@ -121,6 +178,35 @@ void Request::complete(ErrorCode err)
 	handleEvent(Event::RequestComplete);
 }
 
+void Request::merge(Request* other)
+{
+	debug_d("Request %p merged with %p", other, this);
+	merged.add(other);
+	// Flatten the chain
+	Request* req;
+	while((req = other->merged.pop())) {
+		merged.add(req);
+	}
+}
+
+bool Request::unmerge(Request* other)
+{
+	List list;
+	bool found{false};
+	Request* req;
+	while((req = merged.pop())) {
+		if(req == other) {
+			found = true;
+		} else {
+			list.add(req);
+		}
+	}
+	while((req = list.pop())) {
+		merged.add(req);
+	}
+	return found;
+}
+
 String Request::caption() const
 {
 	String s(uint32_t(this), HEX);
@@ -0,0 +1,109 @@
+/**
+ * RequestPool.cpp
+ *
+ * Copyright 2022 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the IOControl Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#include <IO/RequestPool.h>
+#include <IO/Strings.h>
+#include <debug_progmem.h>
+
+namespace IO
+{
+DEFINE_FSTR_LOCAL(FS_capacity, "capacity")
+DEFINE_FSTR_LOCAL(FS_used, "used")
+DEFINE_FSTR_LOCAL(FS_hits, "hits")
+DEFINE_FSTR_LOCAL(FS_misses, "misses")
+
+ErrorCode RequestPool::setCapacity(uint16_t capacity)
+{
+	if(capacity == stats.capacity) {
+		return Error::success;
+	}
+
+	if(stats.used != 0) {
+		debug_w("[IO] Cannot resize request pool, %u blocks in use", stats.used);
+		return Error::busy;
+	}
+
+	freeList = nullptr;
+	storage.reset();
+	stats = Stats{};
+
+	if(capacity == 0) {
+		return Error::success;
+	}
+
+	storage.reset(new uint8_t[capacity * blockSize]);
+	if(!storage) {
+		return Error::no_mem;
+	}
+
+	// Build free list so blocks are handed out in address order
+	for(unsigned i = capacity; i > 0; --i) {
+		auto block = reinterpret_cast<Block*>(&storage[(i - 1) * blockSize]);
+		block->next = freeList;
+		freeList = block;
+	}
+
+	stats.capacity = capacity;
+	debug_d("[IO] Request pool %u x %u bytes", capacity, blockSize);
+	return Error::success;
+}
+
+void* RequestPool::allocate(size_t size)
+{
+	// Inherited request classes may not fit
+	if(stats.capacity == 0 || size > blockSize) {
+		return malloc(size);
+	}
+
+	auto block = freeList;
+	if(block == nullptr) {
+		++stats.misses;
+		return nullptr;
+	}
+
+	freeList = block->next;
+	++stats.hits;
+	++stats.used;
+	stats.highWater = std::max(stats.highWater, stats.used);
+	return block;
+}
+
+void RequestPool::release(void* ptr)
+{
+	if(!contains(ptr)) {
+		free(ptr);
+		return;
+	}
+
+	auto block = static_cast<Block*>(ptr);
+	block->next = freeList;
+	freeList = block;
+	--stats.used;
+}
+
+void RequestPool::getJson(JsonObject json) const
+{
+	json[FS_capacity] = stats.capacity;
+	json[FS_used] = stats.used;
+	json[FS_highwater] = stats.highWater;
+	json[FS_hits] = stats.hits;
+	json[FS_misses] = stats.misses;
+}
+
+} // namespace IO
@@ -18,9 +18,28 @@
  ****/
 
 #include <IO/Serial.h>
+#include <algorithm>
 
 namespace IO
 {
+namespace
+{
+// Use max. value so callback is normally made only on timeout
+constexpr uint8_t RXFIFO_FULL_DEFAULT{0xff};
+
+// Hardware FIFO is 128 bytes, allow some room for latency
+constexpr uint8_t RXFIFO_FULL_MAX{120};
+
+// Receive timeout threshold limits, in character times
+constexpr uint8_t RX_TIMEOUT_MIN{2};
+constexpr uint8_t RX_TIMEOUT_MAX{126};
+
+// Modbus specifies fixed timings above this rate
+constexpr uint32_t FIXED_TIMING_BAUDRATE{19200};
+constexpr uint32_t FIXED_CHAR_GAP{750};
+constexpr uint32_t FIXED_FRAME_GAP{1750};
+} // namespace
+
 ErrorCode Serial::open(uint8_t uart_nr)
 {
 	if(uart != nullptr) {
@@ -41,19 +60,18 @@ ErrorCode Serial::open(uint8_t uart_nr)
 		return Error::bad_config;
 	}
 
-	smg_uart_intr_config_t intr_cfg{
-		// Allow a suitable timeout for receive packets
+	intrConfig = smg_uart_intr_config_t{
+		// Set by updateTiming()
 		.rx_timeout_thresh = 16,
 		// Don't callback unless FIFO is actually empty
 		.txfifo_empty_intr_thresh = 0,
-		// Use max value
-		.rxfifo_full_thresh = 0xff,
+		.rxfifo_full_thresh = RXFIFO_FULL_DEFAULT,
 #ifdef ARCH_ESP32
 		.intr_mask = UART_STATUS_TX_DONE,
 		.intr_enable = UART_STATUS_TX_DONE,
 #endif
 	};
-	smg_uart_intr_config(uart, &intr_cfg);
+	updateTiming();
 	// Don't report 'buffer full' early, but only when buffer is actually full
 	uart->rx_headroom = 0;
 
@@ -66,6 +84,21 @@ void Serial::close()
 	uart = nullptr;
 }
 
+void Serial::setCallback(Callback callback, void* param)
+{
+	this->callback = callback;
+	callbackParam = param;
+	smg_uart_set_callback(uart, callback ? uartCallback : nullptr, this);
+}
+
+void Serial::uartCallback(smg_uart_t* uart, uint32_t status)
+{
+	auto serial = static_cast<Serial*>(smg_uart_get_callback_param(uart));
+	if(serial != nullptr) {
+		serial->notify(status);
+	}
+}
+
 bool Serial::resizeBuffers(size_t rxSize, size_t txSize)
 {
 	if(uart == nullptr) {
@@ -85,10 +118,68 @@ bool Serial::resizeBuffers(size_t rxSize, size_t txSize)
 	return true;
 }
 
+void Serial::setRxFullThreshold(uint8_t threshold)
+{
+	threshold = threshold ? std::min(threshold, RXFIFO_FULL_MAX) : RXFIFO_FULL_DEFAULT;
+	if(uart == nullptr || threshold == intrConfig.rxfifo_full_thresh) {
+		return;
+	}
+
+	intrConfig.rxfifo_full_thresh = threshold;
+	smg_uart_intr_config(uart, &intrConfig);
+}
+
 void Serial::setConfig(const Config& cfg)
 {
+	if(cfg == activeConfig) {
+		return;
+	}
+
 	smg_uart_set_format(uart, cfg.format);
 	smg_uart_set_baudrate(uart, cfg.baudrate);
+	activeConfig = cfg;
+	updateTiming();
+}
+
+Serial::Timing Serial::calculateTiming(const Config& cfg)
+{
+	// Start bit + data bits + parity + stop bits (1.5 rounded up)
+	unsigned bits = 1 + 5 + ((cfg.format & UART_NB_BIT_MASK) >> 2);
+	if((cfg.format & UART_PARITY_MASK) != UART_PARITY_NONE) {
+		++bits;
+	}
+	bits += ((cfg.format & UART_NB_STOP_BIT_MASK) == UART_NB_STOP_BIT_1) ? 1 : 2;
+
+	auto baudrate = std::max(cfg.baudrate, uint32_t(1));
+	Timing t;
+	t.charTime = (bits * 1000000U + baudrate - 1) / baudrate;
+	if(baudrate > FIXED_TIMING_BAUDRATE) {
+		t.charGap = FIXED_CHAR_GAP;
+		t.frameGap = FIXED_FRAME_GAP;
+	} else {
+		t.charGap = t.charTime * 3 / 2;
+		t.frameGap = t.charTime * 7 / 2;
+	}
+	return t;
+}
+
+/*
+ * Receive is complete when the line has been idle for the inter-frame gap.
+ * The UART timeout is measured in character times.
+ */
+void Serial::updateTiming()
+{
+	timing = calculateTiming(activeConfig);
+
+	if(uart == nullptr) {
+		return;
+	}
+
+	unsigned thresh = (timing.frameGap + timing.charTime - 1) / timing.charTime;
+	intrConfig.rx_timeout_thresh = std::min(std::max(thresh, unsigned(RX_TIMEOUT_MIN)), unsigned(RX_TIMEOUT_MAX));
+	smg_uart_intr_config(uart, &intrConfig);
+	debug_d("Serial: %u baud, char %u us, t1.5 %u us, t3.5 %u us, rx timeout %u", activeConfig.baudrate,
+			timing.charTime, timing.charGap, timing.frameGap, intrConfig.rx_timeout_thresh);
 }
 
 } // namespace IO
@@ -0,0 +1,66 @@
+/**
+ * Virtual/Bus.cpp
+ *
+ * Copyright 2022 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the IOControl Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#include <IO/Virtual/Bus.h>
+#include <debug_progmem.h>
+
+namespace IO
+{
+namespace Virtual
+{
+size_t Bus::transmit(uint8_t segment, const IO::Serial::Config& config, const uint8_t* data, size_t size,
+					 uint8_t* response)
+{
+	++stats.frames;
+
+	size_t responseSize{0};
+	unsigned responseCount{0};
+	uint8_t buffer[MAX_RESPONSE];
+	for(auto& slave : slaves) {
+		if(slave.getSegment() != segment || !(slave.getConfig() == config)) {
+			continue;
+		}
+		auto n = slave.receive(data, size, buffer);
+		if(n == 0) {
+			continue;
+		}
+		// Responses from more than one slave garble each other
+		if(++responseCount == 1) {
+			memcpy(response, buffer, n);
+			responseSize = n;
+		}
+	}
+
+	if(responseCount == 0) {
+		++stats.unanswered;
+		return 0;
+	}
+
+	if(responseCount > 1) {
+		debug_w("[VBUS] %u slaves responded on segment %u", responseCount, segment);
+		++stats.collisions;
+		return 0;
+	}
+
+	++stats.responses;
+	return responseSize;
+}
+
+} // namespace Virtual
+} // namespace IO
@@ -0,0 +1,134 @@
+/**
+ * Virtual/Serial.cpp
+ *
+ * Copyright 2022 mikee47 <mike@sillyhouse.net>
+ *
+ * This file is part of the IOControl Library
+ *
+ * This library is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation, version 3 or later.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this library.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#include <IO/Virtual/Serial.h>
+#include <IO/Clock.h>
+#include <debug_progmem.h>
+#include <algorithm>
+
+namespace IO
+{
+namespace Virtual
+{
+ErrorCode Serial::open(uint8_t)
+{
+	if(isOpen) {
+		return Error::access_denied;
+	}
+
+	txTimer.setCallback([](void* param) { static_cast<Serial*>(param)->transmitComplete(); }, this);
+	rxTimer.setCallback([](void* param) { static_cast<Serial*>(param)->receiveComplete(); }, this);
+	updateTiming();
+	isOpen = true;
+	return Error::success;
+}
+
+void Serial::close()
+{
+	txTimer.stop();
+	rxTimer.stop();
+	isOpen = false;
+	clear();
+}
+
+size_t Serial::read(void* buffer, size_t size)
+{
+	size = std::min(size, available());
+	memcpy(buffer, &rxBuffer[rxPos], size);
+	rxPos += size;
+	return size;
+}
+
+/*
+ * Consecutive writes form a single frame, which is complete once the last character
+ * would have left the transmitter.
+ */
+size_t Serial::write(const void* data, size_t len)
+{
+	if(!isOpen) {
+		return 0;
+	}
+
+	len = std::min(len, BUFFER_SIZE - txLength);
+	if(txLength == 0) {
+		txStart = Clock::micros();
+	}
+	memcpy(&txBuffer[txLength], data, len);
+	txLength += len;
+
+	uint32_t txTime = txLength * getTiming().charTime;
+	uint32_t elapsed = Clock::micros() - txStart;
+	txTimer.setIntervalUs(std::max(txTime, elapsed + 1) - elapsed);
+	txTimer.startOnce();
+	return len;
+}
+
+void Serial::clear(smg_uart_mode_t mode)
+{
+	if(mode != UART_TX_ONLY) {
+		rxTimer.stop();
+		rxLength = rxPos = rxPending = 0;
+	}
+	if(mode != UART_RX_ONLY) {
+		txTimer.stop();
+		txLength = 0;
+	}
+}
+
+void Serial::setConfig(const Config& cfg)
+{
+	activeConfig = cfg;
+	updateTiming();
+}
+
+void Serial::transmitComplete()
+{
+	auto size = txLength;
+	txLength = 0;
+	notify(UART_STATUS_TX_DONE | UART_STATUS_TXFIFO_EMPTY);
+
+	rxPending = bus.transmit(segment, activeConfig, txBuffer, size, rxBuffer);
+	if(rxPending == 0) {
+		// Receive times out
+		return;
+	}
+
+	// Response completes early if it reaches the FIFO threshold, otherwise when the line goes idle
+	auto& timing = getTiming();
+	uint32_t delay = bus.getTurnaround() + rxPending * timing.charTime;
+	if(rxFullThreshold != 0 && rxPending >= rxFullThreshold) {
+		rxStatus = UART_STATUS_RXFIFO_FULL;
+	} else {
+		rxStatus = UART_STATUS_RXFIFO_TOUT;
+		delay += timing.frameGap;
+	}
+	rxTimer.setIntervalUs(delay);
+	rxTimer.startOnce();
+}
+
+void Serial::receiveComplete()
+{
+	rxLength = rxPending;
+	rxPos = 0;
+	rxPending = 0;
+	notify(rxStatus);
+}
+
+} // namespace Virtual
+} // namespace IO
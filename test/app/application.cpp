@@ -0,0 +1,39 @@
+#include <SmingTest.h>
+#include <modules.h>
+
+#if !IOCONTROL_VIRTUAL_CLOCK
+#error "Tests require IOCONTROL_VIRTUAL_CLOCK=1"
+#endif
+
+#define XX(t) extern void REGISTER_TEST(t);
+TEST_MAP(XX)
+#undef XX
+
+namespace
+{
+void registerTests()
+{
+#define XX(t)                                                                                                          \
+	REGISTER_TEST(t);                                                                                                  \
+	debug_i("Test '" #t "' registered");
+	TEST_MAP(XX)
+#undef XX
+}
+
+void testsComplete()
+{
+#ifdef ARCH_HOST
+	System.restart();
+#endif
+}
+
+} // namespace
+
+void init()
+{
+	Serial.begin(COM_SPEED_SERIAL);
+	Serial.systemDebugOutput(true);
+
+	registerTests();
+	System.onReady([]() { SmingTest::runner.execute(testsComplete); });
+}
@@ -0,0 +1,12 @@
+COMPONENT_DEPENDS := SmingTest
+ARDUINO_LIBRARIES := \
+	IOControl \
+	ArduinoJson6
+
+COMPONENT_SRCDIRS := app modules
+COMPONENT_INCDIRS := include
+
+DISABLE_NETWORK := 1
+
+# Tests run against simulated time so results don't depend on host speed
+IOCONTROL_VIRTUAL_CLOCK := 1
@@ -0,0 +1,5 @@
+#pragma once
+
+#define TEST_MAP(XX)                                                                                                   \
+	XX(Clock)                                                                                                          \
+	XX(Device)
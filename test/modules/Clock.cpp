@@ -0,0 +1,134 @@
+#include <SmingTest.h>
+#include <IO/Clock.h>
+
+/*
+ * Virtual clock and timers
+ */
+namespace
+{
+struct Event {
+	char id;
+	uint64_t time;
+};
+
+Event events[16];
+unsigned eventCount;
+
+void record(void* param)
+{
+	if(eventCount < ARRAY_SIZE(events)) {
+		events[eventCount++] = Event{char(uintptr_t(param)), IO::Clock::now()};
+	}
+}
+
+void* tag(char id)
+{
+	return reinterpret_cast<void*>(uintptr_t(id));
+}
+
+} // namespace
+
+class ClockTest : public TestGroup
+{
+public:
+	ClockTest() : TestGroup(_F("Clock"))
+	{
+	}
+
+	void execute() override
+	{
+		TEST_CASE("Idle clock doesn't move")
+		{
+			auto start = IO::Clock::now();
+			REQUIRE(!IO::Clock::advance());
+			REQUIRE_EQ(IO::Clock::now(), start);
+		}
+
+		TEST_CASE("Timers fire in deadline order")
+		{
+			eventCount = 0;
+			auto start = IO::Clock::now();
+			IO::ClockTimer a, b, c, d;
+			a.initializeMs(30, record, tag('a'));
+			b.initializeUs(500, record, tag('b'));
+			c.initializeMs(10, record, tag('c'));
+			// Same deadline as `c`, started later
+			d.initializeUs(10000, record, tag('d'));
+			a.startOnce();
+			b.startOnce();
+			c.startOnce();
+			d.startOnce();
+
+			while(IO::Clock::advance()) {
+			}
+
+			REQUIRE_EQ(eventCount, 4U);
+			const Event expected[]{
+				{'b', start + 500},
+				{'c', start + 10000},
+				{'d', start + 10000},
+				{'a', start + 30000},
+			};
+			for(unsigned i = 0; i < eventCount; ++i) {
+				REQUIRE_EQ(events[i].id, expected[i].id);
+				REQUIRE_EQ(events[i].time, expected[i].time);
+			}
+			REQUIRE(!a.isStarted());
+		}
+
+		TEST_CASE("Repeating timer")
+		{
+			eventCount = 0;
+			auto start = IO::Clock::now();
+			IO::ClockTimer a, b;
+			a.initializeMs(10, record, tag('a'));
+			b.initializeMs(25, record, tag('b'));
+			a.start();
+			b.startOnce();
+
+			while(eventCount < 4 && IO::Clock::advance()) {
+			}
+			a.stop();
+
+			const char expected[]{'a', 'a', 'b', 'a'};
+			for(unsigned i = 0; i < 4; ++i) {
+				REQUIRE_EQ(events[i].id, expected[i]);
+			}
+			REQUIRE_EQ(events[3].time, start + 30000);
+			REQUIRE(!IO::Clock::advance());
+		}
+
+		TEST_CASE("Advance limit")
+		{
+			eventCount = 0;
+			auto start = IO::Clock::now();
+			IO::ClockTimer a;
+			a.initializeMs(10, record, tag('a'));
+			a.startOnce();
+			REQUIRE(IO::Clock::advance(4000));
+			REQUIRE_EQ(eventCount, 0U);
+			REQUIRE_EQ(IO::Clock::now(), start + 4000);
+			REQUIRE(IO::Clock::advance());
+			REQUIRE_EQ(eventCount, 1U);
+			REQUIRE_EQ(IO::Clock::now(), start + 10000);
+		}
+
+		TEST_CASE("Random sequence is repeatable")
+		{
+			uint32_t values[8];
+			IO::Clock::seed(1234);
+			for(auto& v : values) {
+				v = IO::Clock::random();
+			}
+			IO::Clock::seed(1234);
+			for(auto v : values) {
+				REQUIRE_EQ(IO::Clock::random(), v);
+			}
+		}
+	}
+};
+
+void REGISTER_TEST(Clock)
+{
+	registerGroup<ClockTest>();
+}
@@ -0,0 +1,157 @@
+#include <SmingTest.h>
+#include <IO/Controller.h>
+#include <IO/DeviceManager.h>
+#include <IO/Strings.h>
+
+/*
+ * Device start-up and fault recovery
+ *
+ * A minimal device completes each request as soon as it's executed with a configurable result,
+ * so the controller runs synchronously apart from its timers.
+ */
+namespace
+{
+DEFINE_FSTR_LOCAL(TEST_CLASSNAME, "test")
+
+class TestController : public IO::Controller
+{
+public:
+	using IO::Controller::Controller;
+
+	const FlashString& classname() const override
+	{
+		return TEST_CLASSNAME;
+	}
+};
+
+class TestDevice : public IO::Device
+{
+public:
+	class Factory : public IO::Device::Factory
+	{
+	public:
+		IO::Device* createDevice(IO::Controller& controller, const char* id) const override
+		{
+			return new TestDevice(controller, id);
+		}
+
+		const FlashString& controllerClass() const override
+		{
+			return TEST_CLASSNAME;
+		}
+
+		const FlashString& deviceClass() const override
+		{
+			return TEST_CLASSNAME;
+		}
+	};
+
+	class Request : public IO::Request
+	{
+	public:
+		using IO::Request::Request;
+
+		bool setNode(IO::DevNode node) override
+		{
+			return true;
+		}
+	};
+
+	static const Factory factory;
+
+	using IO::Device::Device;
+
+	const IO::DeviceType type() const override
+	{
+		// Not used by controller
+		return IO::DeviceType::RFSwitch;
+	}
+
+	IO::ErrorCode init(JsonObjectConst json) override
+	{
+		Config cfg{};
+		parseJson(json, cfg);
+		return IO::Device::init(cfg);
+	}
+
+	IO::Request* createRequest() override
+	{
+		return new Request(*this);
+	}
+
+	void handleEvent(IO::Request* request, IO::Event event) override
+	{
+		IO::Device::handleEvent(request, event);
+		if(event == IO::Event::Execute) {
+			++executeCount;
+			request->complete(result);
+		}
+	}
+
+	IO::ErrorCode result{IO::Error::success};
+	unsigned executeCount{0};
+};
+
+const TestDevice::Factory TestDevice::factory;
+
+TestController controller(0);
+
+} // namespace
+
+class DeviceTest : public TestGroup
+{
+public:
+	DeviceTest() : TestGroup(_F("Device"))
+	{
+	}
+
+	void execute() override
+	{
+		IO::Controller::registerDeviceClass(TestDevice::factory);
+		IO::devmgr.registerController(controller);
+
+		StaticJsonDocument<256> config;
+		config[IO::FS_class] = "test";
+		config[IO::FS_breaker] = 1;
+		IO::Device* dev;
+		auto err = controller.createDevice("dev1", config.as<JsonObjectConst>(), dev);
+		REQUIRE_EQ(err, IO::Error::success);
+		auto& device = static_cast<TestDevice&>(*dev);
+
+		TEST_CASE("Start-up query fails")
+		{
+			device.result = IO::Error::timeout;
+			controller.start();
+			REQUIRE_EQ(device.executeCount, 1U);
+			REQUIRE(device.getState() == IO::Device::State::fault);
+			REQUIRE(device.getBreaker().getState() == IO::CircuitBreaker::State::open);
+		}
+
+		TEST_CASE("Restart rejected by open breaker")
+		{
+			// Query completes with `Error::offline` before submit() returns
+			controller.start();
+			REQUIRE_EQ(device.executeCount, 1U);
+			REQUIRE(device.getState() == IO::Device::State::fault);
+		}
+
+		TEST_CASE("Restart succeeds once breaker allows a probe")
+		{
+			device.result = IO::Error::success;
+			// Device check timer retries start-up
+			while(device.getState() != IO::Device::State::normal && IO::Clock::advance()) {
+			}
+			REQUIRE_EQ(device.executeCount, 2U);
+			REQUIRE(device.getState() == IO::Device::State::normal);
+			REQUIRE(device.getBreaker().getState() == IO::CircuitBreaker::State::closed);
+		}
+
+		controller.stop();
+		controller.freeDevices();
+	}
+};
+
+void REGISTER_TEST(Device)
+{
+	registerGroup<DeviceTest>();
+}